@@ -2,10 +2,28 @@
 
 ENGINE_DIR=src/engine
 
+# number of search threads to build for; more than 1 needs pthreads, and so a cross-origin isolated page
+ENGINE_THREADS=${ENGINE_THREADS:-1}
+# set to 1 for a build with debug info that aborts on a stack overflow instead of silently corrupting memory
+ENGINE_DEBUG=${ENGINE_DEBUG:-0}
+
 set -Eeuo pipefail
 
 cd emsdk 
 source ./emsdk_env.sh 
 cd .. 
 
-emcc $ENGINE_DIR/*.cpp -lembind -o $ENGINE_DIR/engine.mjs -s ALLOW_MEMORY_GROWTH=1 -s MODULARIZE=1 -s EXPORT_ES6=1
+THREAD_FLAGS=""
+if [ "$ENGINE_THREADS" -gt 1 ]; then
+    THREAD_FLAGS="-pthread -s PTHREAD_POOL_SIZE=$((ENGINE_THREADS - 1)) -DMAX_SEARCH_THREADS=$ENGINE_THREADS"
+fi
+
+# the search recurses with a few KB of move lists per ply, far more than Emscripten's default 64 KB stack allows
+STACK_FLAGS="-s STACK_SIZE=1MB -s DEFAULT_PTHREAD_STACK_SIZE=1MB"
+
+DEBUG_FLAGS=""
+if [ "$ENGINE_DEBUG" -eq 1 ]; then
+    DEBUG_FLAGS="-g -s ASSERTIONS=1 -s STACK_OVERFLOW_CHECK=1"
+fi
+
+emcc $ENGINE_DIR/*.cpp $THREAD_FLAGS $STACK_FLAGS $DEBUG_FLAGS -lembind -o $ENGINE_DIR/engine.mjs -s ALLOW_MEMORY_GROWTH=1 -s WASM_BIGINT=1 -s MODULARIZE=1 -s EXPORT_ES6=1
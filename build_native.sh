@@ -0,0 +1,20 @@
+#!/bin/bash
+
+# builds the native engine tools into build/, without Emscripten
+
+ENGINE_DIR=src/engine
+BUILD_DIR=build
+
+set -Eeuo pipefail
+
+mkdir -p $BUILD_DIR
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+
+# everything but the Embind bindings
+ENGINE_SOURCES=$(ls $ENGINE_DIR/*.cpp | grep -v bindings.cpp)
+
+for TOOL in perft uci make_book bench; do
+    $CXX -std=c++17 $CXXFLAGS -pthread $ENGINE_SOURCES $ENGINE_DIR/native/$TOOL.cpp -o $BUILD_DIR/$TOOL
+done
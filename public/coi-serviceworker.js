@@ -0,0 +1,24 @@
+// adds the cross-origin isolation headers to every response the page gets, for hosts like GitHub Pages that can't be set up
+// to send them; with them the page can share memory with the search worker, so it can ponder and stop searches cleanly
+
+self.addEventListener("install", () => self.skipWaiting());
+self.addEventListener("activate", event => event.waitUntil(self.clients.claim()));
+
+self.addEventListener("fetch", event => {
+    const request = event.request;
+    if (request.cache === "only-if-cached" && request.mode !== "same-origin") {
+        return; // fetch() refuses these
+    }
+
+    event.respondWith(fetch(request).then(response => {
+        if (response.status === 0) { // opaque: the headers can't be changed
+            return response;
+        }
+
+        const headers = new Headers(response.headers);
+        headers.set("Cross-Origin-Opener-Policy", "same-origin");
+        headers.set("Cross-Origin-Embedder-Policy", "require-corp");
+        headers.set("Cross-Origin-Resource-Policy", "cross-origin");
+        return new Response(response.body, { status: response.status, statusText: response.statusText, headers });
+    }));
+});
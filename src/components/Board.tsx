@@ -1,9 +1,9 @@
 import { useContext, useState, type ReactNode } from "react";
 
-import type { File, PossibleMove, Rank, StateSetter } from "../types/types";
+import type { File, PieceType, PlayerColor, Rank, StateSetter } from "../types/types";
 
 import { squareToCoord } from "../utils/coordinateConverter";
-import { toEngineGameState, toJSPossibleMove } from "../utils/jsEmbindConverter";
+import { boardAfter, moveDest, movePromotion, moveSource, squarePiece } from "../lib/engineBoard";
 
 import { GameContext } from "../context/GameContext";
 import { ThemeContext } from "../context/ThemeContext";
@@ -12,44 +12,44 @@ import { EngineContext } from "../context/EngineContext";
 interface BoardSquareProps {
     rank: Rank;
     file: File;
+    piece: { color: PlayerColor; type: PieceType } | null;
     setShowPromotionModal: StateSetter<boolean>;
-    setPromotionOptions: StateSetter<PossibleMove[]>;
+    setPromotionOptions: StateSetter<number[]>;
 }
 
 interface PromotionModalProps {
     setShowPromotionModal: StateSetter<boolean>;
-    promotionOptions: PossibleMove[];
+    promotionOptions: number[];
 }
 
-function BoardSquare({ file, rank, setShowPromotionModal, setPromotionOptions }: BoardSquareProps) {
+function BoardSquare({ file, rank, piece, setShowPromotionModal, setPromotionOptions }: BoardSquareProps) {
     const { bgWhite, bgBlack, bgSelected } = useContext(ThemeContext);
-    const { playerColor, gameProgress, gameState, lastMove, selectedSquare, makeMove, setSelectedSquare } = useContext(GameContext);
+    const { playerColor, gameProgress, moves, toMove, selectedSquare, makeMove, setSelectedSquare } = useContext(GameContext);
     const engine: any = useContext(EngineContext);
 
     const coordinate = squareToCoord({ file, rank });
-    const piece = gameState.boardState[coordinate[0]][coordinate[1]];
+    const square = coordinate[1] * 8 + coordinate[0];
 
-    const squareInvolvedInLastMove = gameState.moves >= 1 && ((lastMove.source.file === file && lastMove.source.rank === rank) || (lastMove.dest.file === file && lastMove.dest.rank === rank));
-    const isSelected = selectedSquare?.file === file && selectedSquare?.rank === rank;
+    const lastMove = moves.length >= 1 ? moves[moves.length - 1] : null;
+    const squareInvolvedInLastMove = lastMove !== null && (moveSource(lastMove) === square || moveDest(lastMove) === square);
+    const isSelected = selectedSquare === square;
 
-    const playersTurn = gameProgress === "in progress" && (gameState.toMove === playerColor);
+    const playersTurn = gameProgress === "in progress" && (toMove === playerColor);
 
     const handleSquareClick = () => {
-        // only handle clicks during player's move
-        if (!playersTurn) return;
+        // only handle clicks during player's move, once the engine can say which moves are legal
+        if (!playersTurn || !engine.Board) return;
 
-        const piece = gameState.boardState[coordinate[0]][coordinate[1]];
-        
-        if (piece.active && piece.color === playerColor) {
+        if (piece && piece.color === playerColor) {
             // player clicked on their own piece
 
-            if (selectedSquare?.file === file && selectedSquare?.rank === rank) {
+            if (isSelected) {
                 // player wants to undo selection by clicking on the same square
                 setSelectedSquare(null);
             }
             else {
                 // select the piece
-                setSelectedSquare({ file, rank });
+                setSelectedSquare(square);
             }
         }
         else {
@@ -57,18 +57,9 @@ function BoardSquare({ file, rank, setShowPromotionModal, setPromotionOptions }:
             if (selectedSquare !== null) {
                 // a piece has previously been selected: try to move the piece to this square
 
-                // obtain all legal possible moves that correspond to the player's move
-                const moveOptions: PossibleMove[] = [];
-                const possibleMovesArray = engine.possibleMoves(toEngineGameState(engine, gameState));
-
-                for (let i = 0; i < possibleMovesArray.size(); i++) {
-                    const possibleMove = possibleMovesArray.get(i);
-                    if (possibleMove.move.source.file === selectedSquare.file && possibleMove.move.source.rank === selectedSquare.rank &&
-                        possibleMove.move.dest.file === file && possibleMove.move.dest.rank === rank) {
-                        // this is a legal move
-                        moveOptions.push(toJSPossibleMove(possibleMove));
-                    }
-                }
+                // obtain all legal moves that correspond to the player's move, as the engine's move codes
+                const legalMoves: Uint16Array = boardAfter(engine, moves).legalMoves();
+                const moveOptions = Array.from(legalMoves).filter(code => moveSource(code) === selectedSquare && moveDest(code) === square);
 
                 // do the move, if legal
                 if (moveOptions.length === 0) { // illegal move
@@ -95,7 +86,7 @@ function BoardSquare({ file, rank, setShowPromotionModal, setPromotionOptions }:
             onClick={handleSquareClick}
         >
             {
-                piece.active && 
+                piece && 
                 <div className={`h-full w-full flex items-center justify-center select-none ${playersTurn ? "cursor-pointer" : "cursor-not-allowed"}`}>
                     <img src={`./assets/chess-pieces/${piece.type}-${piece.color}.svg`} className="w-4/5 aspect-square z-100" />
                 </div>
@@ -120,11 +111,11 @@ function PromotionModal({ setShowPromotionModal, promotionOptions }: PromotionMo
             </div>
             <div className="grid grid-cols-2">
                 {
-                    promotionOptions.map(possibleMove => {
-                        const pieceType = possibleMove.move.newPieceType;
+                    promotionOptions.map(code => {
+                        const pieceType = movePromotion(code);
                         return (
                             <img key={pieceType} src={`./assets/chess-pieces/${pieceType}-${playerColor}.svg`} className="w-25 h-25 p-2 cursor-pointer" onClick={() => {
-                                makeMove(possibleMove);
+                                makeMove(code);
                                 setShowPromotionModal(false);
                                 setSelectedSquare(null);
                             }} />
@@ -137,10 +128,14 @@ function PromotionModal({ setShowPromotionModal, promotionOptions }: PromotionMo
 }
 
 export default function Board() {
-    const { playerColor, gameProgress } = useContext(GameContext);
+    const { playerColor, gameProgress, moves } = useContext(GameContext);
+    const engine: any = useContext(EngineContext);
 
     const [showPromotionModal, setShowPromotionModal] = useState(false);
-    const [promotionOptions, setPromotionOptions] = useState<PossibleMove[]>([]);
+    const [promotionOptions, setPromotionOptions] = useState<number[]>([]);
+
+    // the pieces are read from the engine's board, so the board stays empty until the engine has loaded
+    const squares: Uint8Array | null = engine.Board ? boardAfter(engine, moves).squares() : null;
 
     const Squares: ReactNode[] = [];
 
@@ -154,8 +149,10 @@ export default function Board() {
 
     for (const rank of ranks) {
         for (const file of files) {
+            const coordinate = squareToCoord({ file, rank });
+            const piece = squares ? squarePiece(squares[coordinate[1] * 8 + coordinate[0]]) : null;
             Squares.push(
-                <BoardSquare key={`${file}${rank}`} file={file} rank={rank} setShowPromotionModal={setShowPromotionModal} setPromotionOptions={setPromotionOptions} />
+                <BoardSquare key={`${file}${rank}`} file={file} rank={rank} piece={piece} setShowPromotionModal={setShowPromotionModal} setPromotionOptions={setPromotionOptions} />
             );
         }
     }
@@ -4,7 +4,7 @@ import { gameResult } from "../lib/gameInfo";
 
 import { GameContext } from "../context/GameContext";
 import { ThemeContext } from "../context/ThemeContext";
-import { EngineContext } from "../context/EngineContext";
+import { EngineContext, SearchWorkerContext } from "../context/EngineContext";
 
 function PlayAsPrompt() {
     const { bgWhite, bgBlack } = useContext(ThemeContext);
@@ -22,23 +22,32 @@ function PlayAsPrompt() {
 }
 
 function ToMove() {
-    const { gameState, playerColor } = useContext(GameContext);
-    const colorToMove = gameState.toMove;
+    const { toMove: colorToMove, playerColor } = useContext(GameContext);
+    const searchWorker = useContext(SearchWorkerContext);
 
     return (
-        <div className="text-center text-4xl">
-            {(colorToMove === playerColor ? "Your" : "Computer's")} move
+        <div className="flex flex-col items-center text-center space-y-3">
+            <div className="text-4xl">
+                {(colorToMove === playerColor ? "Your" : "Computer's")} move
+            </div>
+            {colorToMove === playerColor && !crossOriginIsolated && (
+                // without shared memory the search worker can't be told a pondered reply was played
+                <div className="text-sm text-[gray]">The computer can't think on your time: this browser didn't isolate the page</div>
+            )}
+            {colorToMove !== playerColor && searchWorker && (
+                <div className="p-1 w-2/3 border rounded-full cursor-pointer bg-[gray]" onClick={() => searchWorker.stop()}>move now</div>
+            )}
         </div>
     );
 }
 
 function GameResult() {
-    const { gameState, playerColor } = useContext(GameContext);
+    const { moves, playerColor } = useContext(GameContext);
     const engine = useContext(EngineContext);
 
     return (
         <div className="text-center text-4xl">
-            {gameResult(engine, gameState, playerColor)}
+            {gameResult(engine, moves, playerColor)}
         </div>
     );
 }
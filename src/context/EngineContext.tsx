@@ -3,44 +3,48 @@ import { createContext, useEffect, useState, type ReactNode } from "react";
 // @ts-ignore
 import ModuleFactory from "../engine/engine.mjs";
 
+import { SearchWorker } from "../lib/searchWorker";
+
 interface EngineContextProviderProps {
     children: ReactNode;
 }
 
-export const EngineContext = createContext({
-    isCheckmate: null,
-    isStalemate: null,
-    threefoldRepetition: null,
-    fiftyMoveRule: null,
-    insufficientMaterial: null,
-    isDraw: null,
-
-    possibleMoves: null,
-    computerMove: null
+// what the page uses of the module: a Board for the rules of the game being shown, and the GameStatus values it reports;
+// both are null until the module has loaded
+export const EngineContext = createContext<any>({
+    Board: null,
+    GameStatus: null
 });
 
+// the computer's moves are searched in a worker; the module above only answers quick rule queries
+export const SearchWorkerContext = createContext<SearchWorker | null>(null);
+
 export default function EngineContextProvider({ children }: EngineContextProviderProps) {
-    const [engine, setEngine] = useState({
-        isCheckmate: null,
-        isStalemate: null,
-        threefoldRepetition: null,
-        fiftyMoveRule: null,
-        insufficientMaterial: null,
-        isDraw: null,
-
-        possibleMoves: null,
-        computerMove: null
+    const [engine, setEngine] = useState<any>({
+        Board: null,
+        GameStatus: null
     });
 
+    const [searchWorker, setSearchWorker] = useState<SearchWorker | null>(null);
+
     useEffect(() => {
         (async () => {
             setEngine(await ModuleFactory());
         })();
     }, []);
 
+    useEffect(() => {
+        const worker = new SearchWorker();
+        setSearchWorker(worker);
+
+        return () => worker.terminate();
+    }, []);
+
     return (
         <EngineContext value={engine}>
-            {children}
+            <SearchWorkerContext value={searchWorker}>
+                {children}
+            </SearchWorkerContext>
         </EngineContext>
     );
 }
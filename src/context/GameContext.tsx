@@ -1,29 +1,27 @@
 import { createContext, useContext, useEffect, useState, type ReactNode } from "react";
 
-import { type BoardState, type File, type GameProgress, type GameState, type Move, type Piece, type PieceType, type PlayerColor, type PossibleMove, type Rank, type Square, type StateSetter } from "../types/types";
+import { type GameProgress, type PlayerColor, type StateSetter } from "../types/types";
 
-import { squareToCoord } from "../utils/coordinateConverter";
-import { toEngineGameState, toJSPossibleMove } from "../utils/jsEmbindConverter";
+import { isGameOver, sideToMove } from "../lib/gameInfo";
 
-import { isGameOver } from "../lib/gameInfo";
+import { EngineContext, SearchWorkerContext } from "./EngineContext";
 
-import { EngineContext } from "./EngineContext";
+const COMPUTER_THINKING_MILLIS = 2000;
 
 interface IGameContext {
     gameProgress: GameProgress;
     playerColor: PlayerColor;
-    gameState: GameState;
-    lastMove: Move;
-    selectedSquare: Square | null;
+    moves: number[]; // the engine's codes of the moves played from the starting position
+    toMove: PlayerColor;
+    selectedSquare: number | null; // 0-63, a1 = 0
 
     setGameProgress: StateSetter<GameProgress>;
     setPlayerColor: StateSetter<PlayerColor>;
-    setGameState: StateSetter<GameState>;
-    setSelectedSquare: StateSetter<Square | null>;
+    setSelectedSquare: StateSetter<number | null>;
 
     resetGame: () => void;
     playAs: (color: PlayerColor) => void;
-    makeMove: (possibleMove: PossibleMove) => void;
+    makeMove: (code: number) => void;
 }
 
 interface GameContextProviderProps {
@@ -33,25 +31,12 @@ interface GameContextProviderProps {
 export const GameContext = createContext<IGameContext>({
     gameProgress: "not started",
     playerColor: "white",
-    gameState: {
-        moves: 0,
-        previousStates: {},
-        lastCaptureOrPawnMove: 0,
-        toMove: "white",
-        castlingAdvantageWhite: 0.0,
-        castlingAdvantageBlack: 0.0,
-        boardState: [[]]
-    },
-    lastMove: {
-        source: { file: "a", rank: "1" },
-        dest: { file: "a", rank: "1" },
-        newPieceType: "pawn"
-    },
+    moves: [],
+    toMove: "white",
     selectedSquare: null,
 
     setGameProgress: () => {},
     setPlayerColor: () => {},
-    setGameState: () => {},
     setSelectedSquare: () => {},
 
     resetGame: () => {},
@@ -62,133 +47,56 @@ export const GameContext = createContext<IGameContext>({
 export default function GameContextProvider({ children }: GameContextProviderProps) {
     const [gameProgress, setGameProgress] = useState<GameProgress>("not started");
     const [playerColor, setPlayerColor] = useState<PlayerColor>("white");
-    
-    const [lastMove, setLastMove] = useState<Move>({
-        source: { file: "a", rank: "1" },
-        dest: { file: "a", rank: "1" },
-        newPieceType: "pawn"
-    });
-
-    const [selectedSquare, setSelectedSquare] = useState<Square | null>(null);
+    const [moves, setMoves] = useState<number[]>([]);
+    const [selectedSquare, setSelectedSquare] = useState<number | null>(null);
 
     const engine: any = useContext(EngineContext);
+    const searchWorker = useContext(SearchWorkerContext);
 
-    const initialBoardState = () => {
-        const initialBoard: BoardState = Array.from({ length: 8 }, () => Array.from({ length: 8 }, () => ({
-            active: false,
-            color: "white",
-            type: "pawn",
-
-            moves: 0,
-            lastMoveIndex: 0
-        } as Piece)));
-
-        const colors: PlayerColor[] = ["white", "black"];
-
-        // put playing pieces into place
-        type NonPawnPiece = Exclude<PieceType, "pawn">;
-        const initialPieceFiles: Record<NonPawnPiece, File[]> = {
-            rook: ["a", "h"],
-            knight: ["b", "g"],
-            bishop: ["c", "f"],
-            queen: ["d"],
-            king: ["e"]
-        };
-        const initialPieceRanks: Record<PlayerColor, Rank> = {
-            white: "1",
-            black: "8"
-        };
-
-        for (const playingPiece in initialPieceFiles) {
-            for (const file of initialPieceFiles[playingPiece as NonPawnPiece]) {
-                for (const color of colors) {
-                    const rank = initialPieceRanks[color];
-
-                    const square: Square = { file, rank };
-                    const coord = squareToCoord(square);
-                    initialBoard[coord[0]][coord[1]] = {
-                        active: true,
-                        color,
-                        type: playingPiece as NonPawnPiece,
-
-                        moves: 0,
-                        lastMoveIndex: 0
-                    };
-                }
-            }
-        }
-
-        // put pawns into place
-        const initialPawnRanks: Record<PlayerColor, Rank> = {
-            white: "2",
-            black: "7"
-        };
-        const initialPawnFiles: File[] = ["a", "b", "c", "d", "e", "f", "g", "h"];
-
-        for (const file of initialPawnFiles) {
-            for (const color of colors) {
-                const rank = initialPawnRanks[color];
-
-                const square: Square = { file, rank };
-                const coord = squareToCoord(square);
-                initialBoard[coord[0]][coord[1]] = {
-                    active: true,
-                    color,
-                    type: "pawn",
-                    
-                    moves: 0,
-                    lastMoveIndex: 0
-                };
-            }
-        }
-
-        return initialBoard;
-    }
-
-    const [gameState, setGameState] = useState<GameState>({
-        moves: 0,
-        previousStates: {},
-        lastCaptureOrPawnMove: 0,
-        toMove: "white",
-        castlingAdvantageWhite: 0.0,
-        castlingAdvantageBlack: 0.0,
-        boardState: initialBoardState()
-    });
+    const toMove = sideToMove(moves);
 
     useEffect(() => {
+        let cancelled = false;
+
         // engine analysis must be async; we must display the player's move on the frontend immediately
         setTimeout(() => {
+            if (cancelled) return;
+
             if (gameProgress === "in progress") {
-                if (isGameOver(engine, gameState)) {
+                if (isGameOver(engine, moves)) {
+                    searchWorker?.stopPondering();
                     setGameProgress("finished");
                     return;
                 }
 
-                if (gameState.toMove !== playerColor) { // do computer's move
-                    const computerMove = engine.computerMove(toEngineGameState(engine, gameState));
-                    makeMove(toJSPossibleMove(computerMove));
+                if (toMove !== playerColor && searchWorker) { // do computer's move
+                    searchWorker.computerMove(moves, COMPUTER_THINKING_MILLIS).then(computerMove => {
+                        if (!cancelled && computerMove !== null) {
+                            makeMove(computerMove);
+                        }
+                    });
                 }
             }
+            else { // nothing more to ponder on
+                searchWorker?.stopPondering();
+            }
         }, 0);
-    }, [gameState, gameProgress, playerColor]);
 
-    const makeMove = (possibleMove: PossibleMove) => {
-        setGameState(possibleMove.gameState);
-        setLastMove(possibleMove.move);
-    }
+        // the game moved on (or was reset) while the computer was thinking, so its move is no longer wanted
+        return () => {
+            cancelled = true;
+            searchWorker?.stop();
+        };
+    }, [moves, gameProgress, playerColor, searchWorker]);
+
+    const makeMove = (code: number) => {
+        setMoves(moves => [...moves, code]);
+    };
 
     const resetGame = () => {
         setGameProgress("not started");
         setPlayerColor("white");
-        setGameState({
-            moves: 0,
-            previousStates: {},
-            lastCaptureOrPawnMove: 0,
-            toMove: "white",
-            castlingAdvantageWhite: 0.0,
-            castlingAdvantageBlack: 0.0,
-            boardState: initialBoardState()
-        });
+        setMoves([]);
         setSelectedSquare(null);
     };
 
@@ -200,13 +108,12 @@ export default function GameContextProvider({ children }: GameContextProviderPro
     const initialGameContext: IGameContext = {
         gameProgress,
         playerColor,
-        gameState,
-        lastMove,
+        moves,
+        toMove,
         selectedSquare,
 
         setGameProgress,
         setPlayerColor,
-        setGameState,
         setSelectedSquare,
 
         resetGame,
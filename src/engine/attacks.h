@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+const uint64_t FILE_A = 0x0101010101010101ULL;
+const uint64_t FILE_H = FILE_A << 7;
+const uint64_t RANK_1 = 0xFFULL;
+const uint64_t RANK_8 = RANK_1 << 56;
+
+// shift a bitboard one step in a direction, dropping bits that would wrap around the board edge
+constexpr uint64_t shift(uint64_t bitboard, int file_step, int rank_step) {
+    for (; file_step > 0; file_step--) bitboard = (bitboard & ~FILE_H) << 1;
+    for (; file_step < 0; file_step++) bitboard = (bitboard & ~FILE_A) >> 1;
+    for (; rank_step > 0; rank_step--) bitboard <<= 8;
+    for (; rank_step < 0; rank_step++) bitboard >>= 8;
+    return bitboard;
+}
+
+// attacks of the pieces that don't slide, for every square, worked out at compile time
+struct LeaperAttacks {
+    uint64_t pawn[2][64];
+    uint64_t knight[64];
+    uint64_t king[64];
+};
+
+constexpr LeaperAttacks generate_leaper_attacks() {
+    LeaperAttacks attacks = {};
+    const int KNIGHT_STEPS[8][2] = {{1, 2}, {1, -2}, {-1, 2}, {-1, -2}, {2, 1}, {2, -1}, {-2, 1}, {-2, -1}};
+    const int KING_STEPS[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+    for (int square = 0; square < 64; square++) {
+        uint64_t bit = 1ULL << square;
+        attacks.pawn[0][square] = shift(bit, -1, 1) | shift(bit, 1, 1); // white
+        attacks.pawn[1][square] = shift(bit, -1, -1) | shift(bit, 1, -1); // black
+
+        for (int i = 0; i < 8; i++) {
+            attacks.knight[square] |= shift(bit, KNIGHT_STEPS[i][0], KNIGHT_STEPS[i][1]);
+            attacks.king[square] |= shift(bit, KING_STEPS[i][0], KING_STEPS[i][1]);
+        }
+    }
+    return attacks;
+}
+
+inline constexpr LeaperAttacks LEAPER_ATTACKS = generate_leaper_attacks();
+
+inline uint64_t pawn_attacks(int color, int square) {
+    return LEAPER_ATTACKS.pawn[color][square];
+}
+
+inline uint64_t knight_attacks(int square) {
+    return LEAPER_ATTACKS.knight[square];
+}
+
+inline uint64_t king_attacks(int square) {
+    return LEAPER_ATTACKS.king[square];
+}
+
+// sliding attacks are looked up by the pieces on the slider's rays (edges left out, as they never block anything further)
+// the blockers are turned into a table index with PEXT where the CPU has it, and otherwise, as in the Wasm build,
+// by multiplying with a magic number that maps every blocker set to a slot holding the right attacks
+struct SliderTable {
+    uint64_t mask; // the rays, without the edge squares
+    uint64_t magic;
+    int shift; // 64 minus the number of squares in mask
+    const uint64_t *attacks; // indexed by blocker set
+};
+
+extern SliderTable BISHOP_TABLES[64];
+extern SliderTable ROOK_TABLES[64];
+extern uint64_t BETWEEN_SQUARES[64][64];
+
+inline size_t slider_index(const SliderTable &table, uint64_t occupied) {
+#ifdef __BMI2__
+    return _pext_u64(occupied, table.mask);
+#else
+    return ((occupied & table.mask) * table.magic) >> table.shift;
+#endif
+}
+
+// sliding pieces stop at (and include) the first occupied square in each direction
+inline uint64_t bishop_attacks(int square, uint64_t occupied) {
+    const SliderTable &table = BISHOP_TABLES[square];
+    return table.attacks[slider_index(table, occupied)];
+}
+
+inline uint64_t rook_attacks(int square, uint64_t occupied) {
+    const SliderTable &table = ROOK_TABLES[square];
+    return table.attacks[slider_index(table, occupied)];
+}
+
+inline uint64_t queen_attacks(int square, uint64_t occupied) {
+    return bishop_attacks(square, occupied) | rook_attacks(square, occupied);
+}
+
+// squares strictly between two squares on the same rank, file or diagonal; empty if they aren't on one
+inline uint64_t between_squares(int a, int b) {
+    return BETWEEN_SQUARES[a][b];
+}
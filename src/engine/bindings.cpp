@@ -0,0 +1,311 @@
+// everything JavaScript sees of the engine; the native tools build the other sources without this file
+
+#include <emscripten/bind.h>
+#include <emscripten/em_js.h>
+
+#include <map>
+#include <algorithm>
+
+#include "structs.h"
+#include "notation.h"
+#include "packed_position.h"
+#include "board_view.h"
+#include "engine_session.h"
+#include "opening_book.h"
+#include "possible_moves.h"
+#include "game_helper_funcs.h"
+#include "strategies.h"
+#include "transposition_table.h"
+#include "endgame_tables.h"
+
+using namespace emscripten;
+
+void set_hash_size(int megabytes) {
+    transposition_table.resize(megabytes);
+}
+
+void clear_hash() {
+    transposition_table.clear();
+}
+
+// of the global table used by computerMove and computerMoveFrom; an EngineSession searches its own table
+TTStats hash_stats() {
+    return transposition_table.current_stats();
+}
+
+// as of the last completed iteration, so JS can read it from onIteration as well as after the search
+SearchStats latest_stats;
+
+SearchStats search_stats() {
+    return latest_stats;
+}
+
+// positions can be passed as a FEN or EPD string, or as the bytes of a packed position in a Uint8Array
+bool read_position(const val &input, Position &position) {
+    if (input.isString()) {
+        std::string text = input.as<std::string>();
+        std::map<std::string, std::string> operations;
+        return parse_epd(text, position, operations) || parse_fen(text, position);
+    }
+
+    std::vector<uint8_t> bytes = convertJSArrayToNumberVector<uint8_t>(input);
+    return bytes.size() == PACKED_POSITION_SIZE && unpack_position(bytes.data(), position);
+}
+
+// null if the input isn't a valid position
+val game_state_from(const val &input) {
+    Position position;
+    if (!read_position(input, position)) {
+        return val::null();
+    }
+    return val(GameState::from_position(position));
+}
+
+std::string game_state_to_fen(const GameState &game_state) {
+    return to_fen(game_state.to_position());
+}
+
+val game_state_to_packed(const GameState &game_state) {
+    PackedPosition packed = pack_position(game_state.to_position());
+    return val::global("Uint8Array").new_(typed_memory_view(PACKED_POSITION_SIZE, packed.bytes));
+}
+
+// best move in UCI notation, or an empty string if the position is invalid or has no moves
+std::string computer_move_from(const val &input, int millis) {
+    Position position;
+    if (!read_position(input, position)) {
+        return "";
+    }
+
+    Move move = iterative_deepening(position, MAX_DEPTH, std::max(millis, 1));
+    return move == NO_MOVE ? "" : move_to_uci(move);
+}
+
+std::vector<std::string> legal_moves_from(const val &input) {
+    std::vector<std::string> legal_moves;
+    Position position;
+    if (!read_position(input, position)) {
+        return legal_moves;
+    }
+
+    MoveList moves;
+    generate_moves(position, moves);
+    for (Move move:moves) {
+        legal_moves.push_back(move_to_uci(move));
+    }
+    return legal_moves;
+}
+
+// views of the board's memory, valid until the Wasm heap grows; read them again after each call that changes the board
+val board_squares(BoardView &board) {
+    return val(typed_memory_view(64, board.squares));
+}
+
+val board_legal_moves(BoardView &board) {
+    return val(typed_memory_view(board.legal_moves.size, reinterpret_cast<const uint16_t*>(board.legal_moves.moves)));
+}
+
+val board_packed_input(BoardView &board) {
+    return val(typed_memory_view(PACKED_POSITION_SIZE, board.packed_input));
+}
+
+int board_side_to_move(BoardView &board) {
+    return board.position.side_to_move;
+}
+
+// the book arrives as the bytes of a fetched .bin file; Embind takes a Uint8Array for the string
+bool load_book(const std::string &book_bytes) {
+    return opening_book.load((const uint8_t*)book_bytes.data(), book_bytes.size());
+}
+
+void close_book() {
+    opening_book.close();
+}
+
+// a worker running a search can't receive messages, so the search asks JS whether it should stop
+EM_JS(int, js_stop_requested, (), {
+    return Module["stopRequested"] && Module["stopRequested"]() ? 1 : 0;
+});
+
+EM_JS(void, js_report_iteration, (int depth, int score, int move), {
+    if (Module["onIteration"]) {
+        Module["onIteration"](depth, score, move);
+    }
+});
+
+EM_JS(int, js_ponder_hit, (), {
+    return Module["ponderHit"] && Module["ponderHit"]() ? 1 : 0;
+});
+
+EMSCRIPTEN_BINDINGS(structs) {
+    register_vector<std::string>("StringVector");
+    register_vector<Piece>("PieceVector");
+    register_vector<std::vector<Piece>>("PieceVectorVector");
+    register_vector<uint64_t>("KeyVector"); // BigInt keys
+
+    value_object<Coordinate>("Coordinate")
+        .field("i", &Coordinate::i)
+        .field("j", &Coordinate::j)
+        ;
+    value_object<Square>("Square")
+        .field("file", &Square::file)
+        .field("rank", &Square::rank)
+        ;
+    value_object<SquareMove>("Move")
+        .field("source", &SquareMove::source)
+        .field("dest", &SquareMove::dest)
+        .field("newPieceType", &SquareMove::new_piece_type)
+        ;
+    value_object<Piece>("Piece")
+        .field("active", &Piece::active)
+        .field("color", &Piece::color)
+        .field("type", &Piece::type)
+        .field("moves", &Piece::moves)
+        .field("lastMoveIndex", &Piece::last_move_index)
+        ;
+    value_object<GameState>("GameState")
+        .field("moves", &GameState::moves)
+        .field("keyHistory", &GameState::key_history)
+        .field("lastCaptureOrPawnMove", &GameState::last_capture_or_pawn_move)
+        .field("toMove", &GameState::to_move)
+        .field("castlingAdvantageWhite", &GameState::castling_advantage_white)
+        .field("castlingAdvantageBlack", &GameState::castling_advantage_black)
+        .field("boardState", &GameState::board_state)
+        ;
+    value_object<PossibleMove>("PossibleMove")
+        .field("move", &PossibleMove::move)
+        .field("gameState", &PossibleMove::game_state)
+        ;
+}
+
+EMSCRIPTEN_BINDINGS(possible_moves_lib) {
+    register_vector<PossibleMove>("PossibleMoveVector");
+    function("possibleMoves", select_overload<std::vector<PossibleMove>(const GameState&)>(&possible_moves));
+}
+
+EMSCRIPTEN_BINDINGS(game_helper_funcs) {
+    function("isCheckmate", select_overload<bool(const GameState&)>(&is_checkmate));
+    function("isStalemate", select_overload<bool(const GameState&)>(&is_stalemate));
+    function("threefoldRepetition", select_overload<bool(const GameState&)>(&threefold_repetition));
+    function("fiftyMoveRule", select_overload<bool(const GameState&)>(&fifty_move_rule));
+    function("insufficientMaterial", select_overload<bool(const GameState&)>(&insufficient_material));
+    function("isDraw", select_overload<bool(const GameState&)>(&is_draw));
+
+    enum_<GameStatus>("GameStatus")
+        .value("IN_PROGRESS", IN_PROGRESS)
+        .value("CHECKMATE", CHECKMATE)
+        .value("STALEMATE", STALEMATE)
+        .value("THREEFOLD_REPETITION", THREEFOLD_REPETITION)
+        .value("FIFTY_MOVE_RULE", FIFTY_MOVE_RULE)
+        .value("INSUFFICIENT_MATERIAL", INSUFFICIENT_MATERIAL)
+        ;
+    function("gameStatus", select_overload<GameStatus(const GameState&)>(&game_status));
+}
+
+EMSCRIPTEN_BINDINGS(strategies) {
+    stop_requested_hook = []() {
+        return js_stop_requested() != 0;
+    };
+    iteration_hook = [](const SearchInfo &info) {
+        latest_stats = info.stats;
+        js_report_iteration(info.depth, info.score, info.pv[0].data);
+    };
+    ponder_hit_hook = []() {
+        return js_ponder_hit() != 0;
+    };
+
+    register_vector<double>("DoubleVector");
+    value_object<SearchStats>("SearchStats")
+        .field("depth", &SearchStats::depth)
+        .field("selectiveDepth", &SearchStats::selective_depth)
+        .field("nodes", &SearchStats::nodes)
+        .field("quiescenceNodes", &SearchStats::quiescence_nodes)
+        .field("nps", &SearchStats::nps)
+        .field("branchingFactor", &SearchStats::branching_factor)
+        .field("betaCutoffs", &SearchStats::beta_cutoffs)
+        .field("cutoffsByMove", &SearchStats::cutoffs_by_move)
+        .field("ttProbes", &SearchStats::tt_probes)
+        .field("ttHits", &SearchStats::tt_hits)
+        .field("millis", &SearchStats::millis)
+        .field("moveGenerationMillis", &SearchStats::move_generation_millis)
+        .field("evaluationMillis", &SearchStats::evaluation_millis)
+        .field("legalityMillis", &SearchStats::legality_millis)
+        ;
+
+    function("computerMove", &computer_move);
+    function("computerMoveTimed", &computer_move_timed);
+    function("setThreads", &set_threads);
+    function("loadBook", &load_book);
+    function("closeBook", &close_book);
+    function("searchStats", &search_stats);
+    function("initEndgameTables", &init_endgame_tables);
+}
+
+EMSCRIPTEN_BINDINGS(board_view) {
+    constant("EMPTY_SQUARE", EMPTY_SQUARE);
+
+    class_<BoardView>("Board")
+        .constructor<>()
+        .function("squares", &board_squares)
+        .function("legalMoves", &board_legal_moves)
+        .function("packedInput", &board_packed_input)
+        .function("sideToMove", &board_side_to_move)
+        .function("load", &BoardView::load)
+        .function("setFen", &BoardView::set_fen)
+        .function("fen", &BoardView::fen)
+        .function("play", &BoardView::play)
+        .function("undo", &BoardView::undo)
+        .function("inCheck", &BoardView::in_check)
+        .function("isCheckmate", &BoardView::is_checkmate)
+        .function("isStalemate", &BoardView::is_stalemate)
+        .function("fiftyMoveRule", &BoardView::fifty_move_rule)
+        .function("insufficientMaterial", &BoardView::insufficient_material)
+        .function("status", &BoardView::status)
+        ;
+}
+
+EMSCRIPTEN_BINDINGS(engine_session) {
+    constant("MAX_DEPTH", MAX_DEPTH);
+
+    class_<EngineSession>("EngineSession")
+        .constructor<>()
+        .function("newGame", &EngineSession::new_game)
+        .function("setFen", &EngineSession::set_fen)
+        .function("fen", &EngineSession::fen)
+        .function("follow", &EngineSession::follow)
+        .function("pushMove", &EngineSession::push_move)
+        .function("undo", &EngineSession::undo)
+        .function("search", &EngineSession::search)
+        .function("ponder", &EngineSession::ponder)
+        .function("expectedReply", &EngineSession::expected_reply_code)
+        .function("status", &EngineSession::status)
+        .function("setHashSize", &EngineSession::set_hash_size)
+        .function("hashStats", &EngineSession::hash_stats)
+        .function("setThreads", &EngineSession::set_threads)
+        .property("ownBook", &EngineSession::own_book)
+        ;
+}
+
+EMSCRIPTEN_BINDINGS(notation) {
+    constant("START_FEN", START_FEN);
+
+    function("gameStateFrom", &game_state_from);
+    function("toFen", &game_state_to_fen);
+    function("toPacked", &game_state_to_packed);
+    function("computerMoveFrom", &computer_move_from);
+    function("legalMovesFrom", &legal_moves_from);
+}
+
+EMSCRIPTEN_BINDINGS(transposition_table) {
+    value_object<TTStats>("TTStats")
+        .field("probes", &TTStats::probes)
+        .field("hits", &TTStats::hits)
+        .field("stores", &TTStats::stores)
+        .field("overwrites", &TTStats::overwrites)
+        .field("sizeMegabytes", &TTStats::size_megabytes)
+        ;
+
+    function("setHashSize", &set_hash_size);
+    function("clearHash", &clear_hash);
+    function("hashStats", &hash_stats);
+}
@@ -0,0 +1,95 @@
+#include <algorithm>
+
+#include "board_view.h"
+#include "notation.h"
+#include "possible_moves.h"
+
+static_assert(sizeof(Move) == sizeof(uint16_t), "JS reads legal_moves as a Uint16Array");
+
+BoardView::BoardView() {
+    parse_fen(START_FEN, position);
+    refresh();
+}
+
+bool BoardView::load() {
+    Position new_position;
+    if (!unpack_position(packed_input, new_position)) {
+        return false;
+    }
+
+    position = new_position;
+    refresh();
+    return true;
+}
+
+bool BoardView::set_fen(const std::string &fen) {
+    Position new_position;
+    if (!parse_fen(fen, new_position)) {
+        return false;
+    }
+
+    position = new_position;
+    refresh();
+    return true;
+}
+
+std::string BoardView::fen() const {
+    return to_fen(position);
+}
+
+bool BoardView::play(int code) {
+    Move move;
+    move.data = (uint16_t)code;
+    if (std::find(legal_moves.begin(), legal_moves.end(), move) == legal_moves.end()) {
+        return false;
+    }
+
+    position.make_move(move);
+    refresh();
+    return true;
+}
+
+bool BoardView::undo() {
+    if (position.undo_stack.empty()) {
+        return false;
+    }
+
+    position.unmake_move();
+    refresh();
+    return true;
+}
+
+bool BoardView::in_check() const {
+    return is_targeted(position, position.king_square(position.side_to_move));
+}
+
+// legal_moves is always up to date, so there's no need to search for a move again
+bool BoardView::is_checkmate() const {
+    return legal_moves.empty() && in_check();
+}
+
+bool BoardView::is_stalemate() const {
+    return legal_moves.empty() && !in_check();
+}
+
+bool BoardView::fifty_move_rule() const {
+    return ::fifty_move_rule(position);
+}
+
+bool BoardView::insufficient_material() const {
+    return ::insufficient_material(position);
+}
+
+GameStatus BoardView::status() {
+    return game_status(position);
+}
+
+void BoardView::refresh() {
+    for (int square = 0; square < 64; square++) {
+        int piece_type = position.board[square];
+        squares[square] = (uint8_t)(piece_type == NO_PIECE_TYPE ? EMPTY_SQUARE : position.color_on(square) * 6 + piece_type);
+    }
+
+    legal_moves.size = 0;
+    generate_moves(position, legal_moves);
+}
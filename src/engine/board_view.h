@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "structs.h"
+#include "packed_position.h"
+#include "game_helper_funcs.h"
+
+const int EMPTY_SQUARE = 12;
+
+// a position kept in Wasm memory, laid out so JS can read it through typed array views of the heap
+// instead of having the board, its moves and every resulting game state copied into JS objects on each call
+struct BoardView {
+    Position position;
+
+    uint8_t squares[64]; // color * 6 + piece type on each square, or EMPTY_SQUARE
+    MoveList legal_moves; // 16-bit move codes, in the same layout as Move
+    uint8_t packed_input[PACKED_POSITION_SIZE] = {}; // JS writes a packed position here and then calls load
+
+    BoardView(); // the starting position
+
+    // replace the position; on failure the old one is kept
+    bool load();
+    bool set_fen(const std::string &fen);
+    std::string fen() const;
+
+    // play one of legal_moves by its code, and take moves back again
+    bool play(int code);
+    bool undo();
+
+    bool in_check() const;
+    bool is_checkmate() const;
+    bool is_stalemate() const;
+    bool fifty_move_rule() const;
+    bool insufficient_material() const;
+    GameStatus status(); // repetitions count the moves played on this board
+
+    // recompute squares and legal_moves after the position changes
+    void refresh();
+};
@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "endgame_tables.h"
+#include "attacks.h"
+#include "possible_moves.h"
+#include "strategies.h"
+#include "utils.h"
+
+// entry values, for the side to move
+const uint8_t TABLE_UNRESOLVED = 0; // a draw once the tables are built
+const uint8_t TABLE_LOSS = 128; // TABLE_LOSS + n: mated in n plies; wins in n plies are stored as n
+const uint8_t TABLE_DRAW = 254;
+const uint8_t TABLE_ILLEGAL = 255;
+
+const int TABLE_SIZE = 2 * 64 * 64 * 64;
+const int TABLE_MAX_PLIES = 125; // the longest mate that fits in an entry
+
+// white is the side with the extra piece; positions where black has it are probed with the board flipped
+// indexed by side to move, white king, black king and the square of the piece
+struct Table {
+    int piece_type;
+    uint8_t entries[TABLE_SIZE];
+};
+
+static Table tables[3] = {{QUEEN, {}}, {ROOK, {}}, {PAWN, {}}}; // promotions look up the first two, so they're built first
+static std::once_flag tables_built;
+static std::atomic<bool> tables_ready(false);
+
+static int table_index(int side_to_move, int white_king, int black_king, int piece) {
+    return ((side_to_move * 64 + white_king) * 64 + black_king) * 64 + piece;
+}
+
+static Table *table_for(int piece_type) {
+    for (Table &table:tables) {
+        if (table.piece_type == piece_type) {
+            return &table;
+        }
+    }
+    return nullptr;
+}
+
+static uint64_t piece_attacks(int piece_type, int square, uint64_t occupied) {
+    switch (piece_type) {
+        case PAWN: return pawn_attacks(WHITE, square);
+        case ROOK: return rook_attacks(square, occupied);
+        default: return queen_attacks(square, occupied);
+    }
+}
+
+static bool is_loss(uint8_t value) {
+    return value >= TABLE_LOSS && value < TABLE_DRAW;
+}
+
+// the value of white pushing its pawn to the square, for black to move
+static uint8_t after_pawn_push(const Table &table, int white_king, int black_king, int dest) {
+    if (rank_of(dest) != 7) {
+        return table.entries[table_index(BLACK, white_king, black_king, dest)];
+    }
+
+    // promote to whichever piece mates sooner; a knight or bishop can't win alone
+    uint8_t best = TABLE_UNRESOLVED;
+    for (int promotion:{QUEEN, ROOK}) {
+        uint8_t value = table_for(promotion)->entries[table_index(BLACK, white_king, black_king, dest)];
+        if (is_loss(value) && (best == TABLE_UNRESOLVED || value < best)) {
+            best = value;
+        }
+    }
+    return best;
+}
+
+// black's legal king moves; capturing an undefended piece leaves a drawn king against king
+static uint64_t black_king_dests(const Table &table, int white_king, int black_king, int piece) {
+    uint64_t occupied_without_king = square_bit(white_king) | square_bit(piece);
+    uint64_t attacked = king_attacks(white_king) | piece_attacks(table.piece_type, piece, occupied_without_king);
+    return king_attacks(black_king) & ~attacked & ~square_bit(white_king);
+}
+
+// white-to-move positions that reach the black-to-move position in one move; some may be illegal
+static int white_predecessors(const Table &table, int white_king, int black_king, int piece, int *predecessors) {
+    int count = 0;
+    uint64_t occupied = square_bit(white_king) | square_bit(black_king) | square_bit(piece);
+
+    uint64_t king_sources = king_attacks(white_king) & ~occupied & ~king_attacks(black_king);
+    while (king_sources) {
+        predecessors[count++] = table_index(WHITE, pop_lsb(king_sources), black_king, piece);
+    }
+
+    if (table.piece_type == PAWN) {
+        if (rank_of(piece) >= 2 && !(occupied & square_bit(piece - 8))) {
+            predecessors[count++] = table_index(WHITE, white_king, black_king, piece - 8);
+            if (rank_of(piece) == 3 && !(occupied & square_bit(piece - 16))) {
+                predecessors[count++] = table_index(WHITE, white_king, black_king, piece - 16);
+            }
+        }
+        return count;
+    }
+
+    // a slider can come back along any line it can move along
+    uint64_t piece_sources = piece_attacks(table.piece_type, piece, occupied) & ~occupied;
+    while (piece_sources) {
+        predecessors[count++] = table_index(WHITE, white_king, black_king, pop_lsb(piece_sources));
+    }
+    return count;
+}
+
+// works backwards from the mates: a position where black is lost makes every white move into it a win one ply longer,
+// and a position black can only leave into white wins is lost one ply after the longest of them
+// positions are handled in order of plies to mate, so the first value a position gets is the shortest
+static void build_table(Table &table) {
+    uint8_t *entries = table.entries;
+
+    // how many of black's moves don't lead to a known white win yet; CAN_DRAW if one captures the piece
+    const uint8_t CAN_DRAW = 255;
+    std::vector<uint8_t> escapes(TABLE_SIZE / 2);
+    std::vector<std::vector<int>> by_plies(TABLE_MAX_PLIES + 1);
+
+    for (int index = 0; index < TABLE_SIZE; index++) {
+        int piece = index & 63;
+        int black_king = (index >> 6) & 63;
+        int white_king = (index >> 12) & 63;
+        int side_to_move = index >> 18;
+
+        uint64_t occupied = square_bit(white_king) | square_bit(black_king) | square_bit(piece);
+        bool black_in_check = piece_attacks(table.piece_type, piece, occupied) & square_bit(black_king);
+        entries[index] = TABLE_UNRESOLVED;
+
+        if (pop_count(occupied) < 3 || (king_attacks(white_king) & square_bit(black_king)) ||
+            (table.piece_type == PAWN && (rank_of(piece) == 0 || rank_of(piece) == 7)) || (side_to_move == WHITE && black_in_check)) {
+            entries[index] = TABLE_ILLEGAL;
+        }
+        else if (side_to_move == BLACK) {
+            uint64_t dests = black_king_dests(table, white_king, black_king, piece);
+            escapes[index & (TABLE_SIZE / 2 - 1)] = (dests & square_bit(piece) ? CAN_DRAW : (uint8_t)pop_count(dests));
+
+            if (!dests) {
+                entries[index] = (black_in_check ? TABLE_LOSS : TABLE_DRAW);
+                if (black_in_check) {
+                    by_plies[0].push_back(index);
+                }
+            }
+        }
+        else if (table.piece_type == PAWN && rank_of(piece) == 6 && !(occupied & square_bit(piece + 8))) {
+            // promoting wins one ply after the mate it leads to
+            uint8_t value = after_pawn_push(table, white_king, black_king, piece + 8);
+            if (is_loss(value) && value - TABLE_LOSS < TABLE_MAX_PLIES) {
+                by_plies[value - TABLE_LOSS + 1].push_back(index);
+            }
+        }
+    }
+
+    int predecessors[64];
+    for (int plies = 0; plies <= TABLE_MAX_PLIES; plies++) {
+        for (size_t i = 0; i < by_plies[plies].size(); i++) {
+            int index = by_plies[plies][i];
+            int piece = index & 63;
+            int black_king = (index >> 6) & 63;
+            int white_king = (index >> 12) & 63;
+
+            if ((index >> 18) == BLACK) { // black is mated in plies plies
+                if (plies == TABLE_MAX_PLIES) {
+                    continue;
+                }
+
+                int count = white_predecessors(table, white_king, black_king, piece, predecessors);
+                for (int j = 0; j < count; j++) {
+                    if (entries[predecessors[j]] == TABLE_UNRESOLVED) {
+                        by_plies[plies + 1].push_back(predecessors[j]);
+                    }
+                }
+                continue;
+            }
+
+            // white wins in plies plies, unless a shorter win was found first
+            if (entries[index] != TABLE_UNRESOLVED) {
+                continue;
+            }
+            entries[index] = (uint8_t)plies;
+            if (plies == TABLE_MAX_PLIES) {
+                continue;
+            }
+
+            // black positions that can move here: one fewer escape each
+            uint64_t sources = king_attacks(black_king) & ~square_bit(white_king) & ~square_bit(piece) & ~king_attacks(white_king);
+            while (sources) {
+                int predecessor = table_index(BLACK, white_king, pop_lsb(sources), piece);
+                uint8_t &escape_count = escapes[predecessor & (TABLE_SIZE / 2 - 1)];
+                if (entries[predecessor] != TABLE_UNRESOLVED || escape_count == CAN_DRAW) {
+                    continue;
+                }
+
+                if (--escape_count == 0) {
+                    entries[predecessor] = (uint8_t)(TABLE_LOSS + plies + 1);
+                    by_plies[plies + 1].push_back(predecessor);
+                }
+            }
+        }
+    }
+}
+
+void init_endgame_tables() {
+    std::call_once(tables_built, []() {
+        for (Table &table:tables) {
+            build_table(table);
+        }
+        tables_ready.store(true, std::memory_order_release);
+    });
+}
+
+bool probe_endgame_tables(const Position &position, EndgameResult &result) {
+    uint64_t occupied = position.occupied();
+    if (pop_count(occupied) > ENDGAME_TABLE_PIECES || position.castling_rights) {
+        return false;
+    }
+
+    result = EndgameResult();
+    uint64_t others = occupied & ~position.pieces[WHITE][KING] & ~position.pieces[BLACK][KING];
+    if (!others) { // king against king
+        return true;
+    }
+
+    int piece = lsb(others);
+    int strong = position.color_on(piece);
+    Table *table = table_for(position.board[piece]);
+    if (!table) { // a lone knight or bishop can't mate
+        return true;
+    }
+    if (!tables_ready.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    // look the position up with the strong side as white
+    int flip = (strong == WHITE ? 0 : 56);
+    int side_to_move = position.side_to_move ^ strong;
+    uint8_t value = table->entries[table_index(side_to_move, position.king_square(strong) ^ flip, position.king_square(strong ^ 1) ^ flip, piece ^ flip)];
+
+    if (value == TABLE_ILLEGAL) {
+        return false;
+    }
+    if (value >= TABLE_LOSS && value < TABLE_DRAW) {
+        result = {-1, value - TABLE_LOSS};
+    }
+    else if (value != TABLE_UNRESOLVED && value < TABLE_LOSS) {
+        result = {1, value};
+    }
+
+    // nothing resets the clock on the way to a queen or rook mate, so one that comes too late is a draw; a pawn ending's
+    // clock starts again with each push, so those are taken as won
+    if (table->piece_type != PAWN && position.halfmove_clock + result.plies > 100) {
+        result = EndgameResult();
+    }
+    return true;
+}
+
+int endgame_table_score(const EndgameResult &result, int ply) {
+    if (result.wdl == 0) {
+        return 0;
+    }
+    int mate_score = MATE_SCORE - ply - result.plies;
+    return (result.wdl > 0 ? mate_score : -mate_score);
+}
+
+Move endgame_table_move(Position &position, int &score) {
+    EndgameResult result;
+    if (!probe_endgame_tables(position, result)) {
+        return NO_MOVE;
+    }
+
+    MoveList moves;
+    generate_moves(position, moves);
+
+    Move best_move = NO_MOVE;
+    int best_score = -MATE_SCORE - 1;
+    for (Move move:moves) {
+        position.make_move(move);
+        EndgameResult child;
+        bool found = probe_endgame_tables(position, child);
+        position.unmake_move();
+
+        if (!found) { // a promotion to a second piece, say; leave it to the search
+            return NO_MOVE;
+        }
+
+        int move_score = -endgame_table_score(child, 1);
+        if (move_score > best_score) {
+            best_score = move_score;
+            best_move = move;
+        }
+    }
+
+    score = best_score;
+    return best_move;
+}
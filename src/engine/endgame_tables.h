@@ -0,0 +1,27 @@
+#pragma once
+
+#include "structs.h"
+
+const int ENDGAME_TABLE_PIECES = 3;
+
+// what perfect play gets the side to move, and how many plies it takes to mate when it isn't a draw
+struct EndgameResult {
+    int wdl = 0; // 1 win, 0 draw, -1 loss
+    int plies = 0;
+};
+
+// distance-to-mate tables for every position with the two kings and at most one other piece, built by retrograde analysis
+// rather than read from files; a queen or rook win that can't mate before the fifty-move rule is a draw
+// false if the position isn't covered (too many pieces, castling rights left, or the tables aren't built yet)
+bool probe_endgame_tables(const Position &position, EndgameResult &result);
+
+// the move that keeps the result and mates fastest (or holds out longest), with its score in the search's mate scale;
+// NO_MOVE if the position isn't covered
+Move endgame_table_move(Position &position, int &score);
+
+// the search's score for an endgame table result ply plies from the root
+int endgame_table_score(const EndgameResult &result, int ply);
+
+// builds the tables, once; takes a fraction of a second, so callers do it before any search is timed (at startup, or on
+// another thread) and the search simply doesn't probe them until they're ready
+void init_endgame_tables();
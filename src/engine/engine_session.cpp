@@ -0,0 +1,141 @@
+#include <algorithm>
+
+#include "engine_session.h"
+#include "notation.h"
+#include "possible_moves.h"
+#include "opening_book.h"
+
+EngineSession::EngineSession() {
+    search_state.table = &table;
+    parse_fen(START_FEN, position);
+}
+
+void EngineSession::new_game() {
+    parse_fen(START_FEN, position);
+    table.clear();
+    search_state.clear();
+}
+
+bool EngineSession::set_fen(const std::string &fen) {
+    Position new_position;
+    if (!parse_fen(fen, new_position)) {
+        return false;
+    }
+
+    position = new_position;
+    return true;
+}
+
+std::string EngineSession::fen() const {
+    return to_fen(position);
+}
+
+void EngineSession::follow(const GameState &game_state) {
+    Position target = game_state.to_position();
+    if (position.key == target.key) {
+        return;
+    }
+
+    // moves taken back
+    int undoable = (int)std::min(position.undo_stack.size(), position.key_history.size());
+    for (int count = 1; count <= undoable; count++) {
+        if (position.key_history[position.key_history.size() - count] == target.key) {
+            for (int i = 0; i < count; i++) {
+                position.unmake_move();
+            }
+            return;
+        }
+    }
+
+    // a move, or a move and the reply to it, played since
+    MoveList moves;
+    generate_moves(position, moves);
+    for (Move move:moves) {
+        position.make_move(move);
+        if (position.key == target.key) {
+            return;
+        }
+
+        MoveList replies;
+        generate_moves(position, replies);
+        for (Move reply:replies) {
+            position.make_move(reply);
+            if (position.key == target.key) {
+                return;
+            }
+            position.unmake_move();
+        }
+        position.unmake_move();
+    }
+
+    position = target;
+}
+
+bool EngineSession::push_move(int code) {
+    Move move;
+    move.data = (uint16_t)code;
+
+    MoveList moves;
+    generate_moves(position, moves);
+    if (std::find(moves.begin(), moves.end(), move) == moves.end()) {
+        return false;
+    }
+
+    position.make_move(move);
+    return true;
+}
+
+bool EngineSession::undo() {
+    if (position.undo_stack.empty()) {
+        return false;
+    }
+
+    position.unmake_move();
+    return true;
+}
+
+int EngineSession::search(int max_depth, int millis) {
+    return best_move(max_depth, millis, false);
+}
+
+int EngineSession::ponder(int millis) {
+    return best_move(MAX_DEPTH, millis, true);
+}
+
+int EngineSession::expected_reply_code() const {
+    return expected_reply.data;
+}
+
+int EngineSession::best_move(int max_depth, int millis, bool ponder) {
+    expected_reply = NO_MOVE;
+    if (own_book) {
+        Move book_move = opening_book.probe(position);
+        if (book_move != NO_MOVE) {
+            return book_move.data;
+        }
+    }
+
+    Move move = iterative_deepening(position, std::clamp(max_depth, 1, MAX_DEPTH), std::max(millis, 0), &search_state, ponder);
+    if (move != NO_MOVE) {
+        std::vector<Move> pv = principal_variation(position, table, move, 2);
+        expected_reply = (pv.size() > 1 ? pv[1] : NO_MOVE);
+    }
+    return move.data;
+}
+
+GameStatus EngineSession::status() {
+    return game_status(position);
+}
+
+void EngineSession::set_hash_size(int megabytes) {
+    table.resize(megabytes);
+}
+
+TTStats EngineSession::hash_stats() const {
+    return table.current_stats();
+}
+
+int EngineSession::set_threads(int threads) {
+    search_state.threads = std::clamp(threads, 1, MAX_SEARCH_THREADS);
+    return search_state.threads;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+
+#include "structs.h"
+#include "strategies.h"
+#include "transposition_table.h"
+#include "game_helper_funcs.h"
+
+// one game against the engine, kept in Wasm memory between moves: the position with the moves that led to it,
+// and its own transposition table and move ordering statistics, so each search picks up where the last one stopped
+// and only the moves played have to cross from JS
+struct EngineSession {
+    Position position;
+    TranspositionTable table;
+    SearchState search_state;
+    bool own_book = true;
+    Move expected_reply = NO_MOVE; // the opponent's best reply to the move the last search found, if it got that far
+
+    EngineSession(); // the starting position
+
+    // back to the starting position, forgetting everything the searches have learned
+    void new_game();
+    // start from another position, without its history; on failure the old one is kept
+    bool set_fen(const std::string &fen);
+    std::string fen() const;
+
+    // catch up with a game played elsewhere: plays or takes back the moves that lead to it if there are at most two,
+    // and otherwise starts over from it, keeping the transposition table
+    void follow(const GameState &game_state);
+
+    // play a legal move by its 16-bit code, and take moves back again
+    bool push_move(int code);
+    bool undo();
+
+    // the best move's code, or 0 if there are no legal moves; an opening book move is played straight away when own_book is set
+    // stops at max_depth, or once the time budget (in milliseconds) is nearly spent; a millis of 0 means no time limit
+    int search(int max_depth, int millis);
+    // the same, on the position the opponent is expected to leave, while they think: the search has no time limit until
+    // the ponder hit hook fires, and then runs for millis more; it ends sooner if stopped, or at MAX_DEPTH or a mate
+    int ponder(int millis);
+    int expected_reply_code() const;
+
+    GameStatus status();
+
+    void set_hash_size(int megabytes);
+    TTStats hash_stats() const; // of this session's table, not the global one the free functions search with
+    int set_threads(int threads); // returns the number actually used
+
+    // what search and ponder share
+    int best_move(int max_depth, int millis, bool ponder);
+};
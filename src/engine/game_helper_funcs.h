@@ -1,10 +1,40 @@
 #pragma once
 
 #include "structs.h"
+#include "possible_moves.h"
 
-Square king_square(const GameState &game_state);
-bool is_targeted(const GameState &game_state, Square square);
+enum GameStatus {
+    IN_PROGRESS,
+    CHECKMATE,
+    STALEMATE,
+    THREEFOLD_REPETITION,
+    FIFTY_MOVE_RULE,
+    INSUFFICIENT_MATERIAL
+};
 
+int king_square(const Position &position);
+// pieces of by_color attacking the square, with sliding attacks blocked by the given occupancy
+uint64_t attackers_to(const Position &position, int square, int by_color, uint64_t occupied);
+bool is_attacked(const Position &position, int square, int by_color);
+bool is_targeted(const Position &position, int square);
+
+bool fifty_move_rule(const Position &position);
+bool insufficient_material(const Position &position);
+// the position has occurred twice before, going by its key history
+bool threefold_repetition(const Position &position);
+
+// these play moves on the position while checking, and restore it before returning
+bool has_legal_move(Position &position, const MoveGenInfo &info);
+bool no_moves_left(Position &position);
+bool is_stalemate(Position &position);
+bool is_checkmate(Position &position);
+bool is_draw(Position &position);
+
+// whether and how the game has ended, from one look at the checkers and the legal moves
+// checkmate and stalemate take precedence over the draw rules
+GameStatus game_status(Position &position);
+
+// Embind entry points: convert the game state and defer to the native versions
 bool is_stalemate(const GameState &game_state);
 bool is_checkmate(const GameState &game_state);
 bool threefold_repetition(const GameState &game_state);
@@ -12,3 +42,4 @@ bool fifty_move_rule(const GameState &game_state);
 bool insufficient_material(const GameState &game_state);
 
 bool is_draw(const GameState &game_state);
+GameStatus game_status(const GameState &game_state);
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "move_picker.h"
+#include "see.h"
+
+MovePicker::MovePicker(Position &position, const MoveGenInfo &info, Move hash_move, const Move (&killers)[2], const int (&history)[64][64])
+    : position(position), info(info), hash_move(hash_move), killers{killers[0], killers[1]}, history(history) {}
+
+MovePicker::MovePicker(Position &position, const MoveGenInfo &info)
+    : position(position), info(info), hash_move(NO_MOVE), killers{NO_MOVE, NO_MOVE}, history(nullptr), noisy_only(true), stage(STAGE_GENERATE_CAPTURES) {}
+
+Move MovePicker::next() {
+    while (true) {
+        switch (stage) {
+            case STAGE_HASH_MOVE:
+                stage++;
+                if (is_pseudo_legal(position, info, hash_move) && is_legal(position, info, hash_move)) {
+                    return hash_move;
+                }
+                break;
+
+            case STAGE_GENERATE_CAPTURES:
+                generate_pseudo_legal(position, info, moves, GEN_NOISY);
+                score_captures();
+                current = 0;
+                stage++;
+                break;
+
+            case STAGE_CAPTURES:
+                while (current < moves.size) {
+                    Move move = pick_best();
+                    if (move == hash_move) {
+                        continue;
+                    }
+                    if (!noisy_only && move.is_capture() && see(position, move) < 0) { // try it after the quiet moves
+                        bad_captures.push_back(move);
+                        continue;
+                    }
+                    if (is_legal(position, info, move)) {
+                        return move;
+                    }
+                }
+                stage = (noisy_only ? STAGE_DONE : STAGE_KILLERS);
+                break;
+
+            case STAGE_KILLERS:
+                while (killer_index < 2) {
+                    Move killer = killers[killer_index++];
+                    // a killer comes from another position, so it may not even be possible here
+                    if (killer != hash_move && !killer.is_noisy() && is_pseudo_legal(position, info, killer) && is_legal(position, info, killer)) {
+                        return killer;
+                    }
+                }
+                stage++;
+                break;
+
+            case STAGE_GENERATE_QUIETS:
+                moves.size = 0;
+                generate_pseudo_legal(position, info, moves, GEN_QUIET);
+                score_quiets();
+                current = 0;
+                stage++;
+                break;
+
+            case STAGE_QUIETS:
+                while (current < moves.size) {
+                    Move move = pick_best();
+                    if (move != hash_move && move != killers[0] && move != killers[1] && is_legal(position, info, move)) {
+                        return move;
+                    }
+                }
+                stage++;
+                break;
+
+            case STAGE_BAD_CAPTURES:
+                while (bad_capture_index < bad_captures.size) {
+                    Move move = bad_captures[bad_capture_index++];
+                    if (is_legal(position, info, move)) {
+                        return move;
+                    }
+                }
+                stage++;
+                break;
+
+            default:
+                return NO_MOVE;
+        }
+    }
+}
+
+// most valuable victim first, and of those the least valuable attacker; promotions count the piece gained
+void MovePicker::score_captures() {
+    for (int i = 0; i < moves.size; i++) {
+        Move move = moves[i];
+        int victim = (move.flags() == EN_PASSANT ? (int)PAWN : (int)position.board[move.dest()]);
+
+        int score = 0;
+        if (move.is_capture()) {
+            score += 8 * PIECE_VALUES[victim] - PIECE_VALUES[position.board[move.source()]] / 100;
+        }
+        if (move.is_promotion()) {
+            score += PIECE_VALUES[move.promotion()];
+        }
+        scores[i] = score;
+    }
+}
+
+void MovePicker::score_quiets() {
+    for (int i = 0; i < moves.size; i++) {
+        scores[i] = history[moves[i].source()][moves[i].dest()];
+    }
+}
+
+Move MovePicker::pick_best() {
+    int best = current;
+    for (int i = current + 1; i < moves.size; i++) {
+        if (scores[i] > scores[best]) {
+            best = i;
+        }
+    }
+
+    std::swap(moves[current], moves[best]);
+    std::swap(scores[current], scores[best]);
+    return moves[current++];
+}
+
+void update_history(int &entry, int bonus) {
+    // the closer the entry already is to the limit, the less it moves
+    bonus = std::clamp(bonus, -HISTORY_MAX, HISTORY_MAX);
+    entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+}
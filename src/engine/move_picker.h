@@ -0,0 +1,55 @@
+#pragma once
+
+#include "structs.h"
+#include "possible_moves.h"
+
+const int HISTORY_MAX = 16384;
+
+enum PickerStage {
+    STAGE_HASH_MOVE,
+    STAGE_GENERATE_CAPTURES,
+    STAGE_CAPTURES,
+    STAGE_KILLERS,
+    STAGE_GENERATE_QUIETS,
+    STAGE_QUIETS,
+    STAGE_BAD_CAPTURES,
+    STAGE_DONE
+};
+
+// hands out the legal moves of a position one at a time, most promising first:
+// the hash move, captures that don't lose material (by SEE) in MVV-LVA order, the killer moves,
+// quiet moves by history score, and finally the losing captures
+// each stage is only generated once the previous one runs out, so after a cutoff the rest are never generated or scored
+struct MovePicker {
+    Position &position;
+    MoveGenInfo info;
+
+    Move hash_move;
+    Move killers[2];
+    const int (*history)[64]; // history[source][dest] for the side to move
+    bool noisy_only = false;
+
+    int stage = STAGE_HASH_MOVE;
+    MoveList moves;
+    int scores[MAX_MOVES];
+    int current = 0;
+    int killer_index = 0;
+    MoveList bad_captures;
+    int bad_capture_index = 0;
+
+    // info is the position's move_gen_info, which the caller usually needs anyway to know whether it is in check
+    MovePicker(Position &position, const MoveGenInfo &info, Move hash_move, const Move (&killers)[2], const int (&history)[64][64]);
+
+    // captures and promotions only, for the quiescence search; losing captures aren't held back
+    MovePicker(Position &position, const MoveGenInfo &info);
+
+    // the next legal move, or NO_MOVE once there are none left
+    Move next();
+
+    void score_captures();
+    void score_quiets();
+    Move pick_best(); // selection sort, one move at a time
+};
+
+// moves history scores towards the bonus (negative for a penalty), staying within +-HISTORY_MAX
+void update_history(int &entry, int bonus);
@@ -0,0 +1,77 @@
+// builds an opening book for the engine from games given as lines of UCI moves ("e2e4 e7e5 g1f3 ..."),
+// weighting each move by how often it was played; see opening_book.h for the format
+// usage: make_book <games.txt> <book.bin> [max plies, default 16]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../structs.h"
+#include "../notation.h"
+#include "../opening_book.h"
+
+const int DEFAULT_MAX_PLIES = 16;
+const int MAX_WEIGHT = 65535;
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        printf("usage: make_book <games.txt> <book.bin> [max plies]\n");
+        return 1;
+    }
+
+    std::ifstream games(argv[1]);
+    if (!games) {
+        printf("can't read %s\n", argv[1]);
+        return 1;
+    }
+    int max_plies = (argc > 3 ? atoi(argv[3]) : DEFAULT_MAX_PLIES);
+
+    std::map<std::pair<uint64_t, uint16_t>, int> counts;
+    std::string line;
+    int game_count = 0;
+    while (std::getline(games, line)) {
+        Position position;
+        parse_fen(START_FEN, position);
+
+        std::istringstream moves(line);
+        std::string uci;
+        for (int ply = 0; ply < max_plies && moves >> uci; ply++) {
+            Move move = parse_uci_move(position, uci);
+            if (move == NO_MOVE) {
+                printf("game %d: illegal move %s\n", game_count + 1, uci.c_str());
+                break;
+            }
+
+            counts[{polyglot_key(position), to_book_move(move)}]++;
+            position.make_move(move);
+        }
+        game_count++;
+    }
+
+    // the map is already in key order, which is the order probing needs
+    std::vector<uint8_t> book(counts.size() * BOOK_ENTRY_SIZE);
+    size_t index = 0;
+    for (auto [key_and_move, count]:counts) {
+        BookEntry entry;
+        entry.key = key_and_move.first;
+        entry.move = key_and_move.second;
+        entry.weight = (uint16_t)std::min(count, MAX_WEIGHT);
+        write_book_entry(entry, &book[index++ * BOOK_ENTRY_SIZE]);
+    }
+
+    FILE *output = fopen(argv[2], "wb");
+    if (!output || fwrite(book.data(), 1, book.size(), output) != book.size()) {
+        printf("can't write %s\n", argv[2]);
+        return 1;
+    }
+    fclose(output);
+
+    printf("%zu entries from %d games\n", counts.size(), game_count);
+    return 0;
+}
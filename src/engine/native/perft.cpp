@@ -0,0 +1,242 @@
+// native perft tool: counts the leaf nodes of the legal move tree, to check the move generator and measure its speed
+//
+//   perft <depth> [fen]          total node count and nodes per second
+//   perft divide <depth> [fen]   node count below each root move
+//   perft suite                  standard positions with known counts, FENs that must be rejected and Polyglot book keys;
+//                                exits with status 1 on any mismatch
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include "../structs.h"
+#include "../possible_moves.h"
+#include "../notation.h"
+#include "../opening_book.h"
+
+struct PerftCase {
+    std::string name;
+    std::string fen;
+    int depth;
+    uint64_t nodes;
+};
+
+// https://www.chessprogramming.org/Perft_Results
+const PerftCase PERFT_SUITE[] = {
+    {"start position", START_FEN, 5, 4865609},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+    {"en passant and rook endgame", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083},
+    {"promotions and castling", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292},
+    {"promotion with check", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+    {"middlegame", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+    {"en passant discovered check", "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467},
+    {"short castling gives check", "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072},
+    {"long castling gives check", "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711},
+    {"castle rights", "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206},
+    {"castling prevented", "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476},
+    {"promote out of check", "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001},
+    {"discovered check", "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658},
+    {"promote to give check", "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342},
+    {"underpromote to check", "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683},
+    {"self stalemate", "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217},
+    {"stalemate and checkmate", "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584},
+    {"double check", "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527},
+};
+
+// positions that can't arise in a game, and that the move generator doesn't have to cope with
+const std::pair<std::string, std::string> INVALID_FENS[] = {
+    {"side not to move in check", "4k3/4R3/8/8/8/8/8/4K3 w - - 0 1"},
+    {"pawn on the back rank", "P3k3/8/8/8/8/8/8/4K3 w - - 0 1"},
+    {"missing king", "8/8/8/8/8/8/8/4K3 w - - 0 1"},
+};
+
+struct PolyglotCase {
+    std::string name;
+    std::string fen;
+    uint64_t key;
+};
+
+// the test positions from the Polyglot book format description
+const PolyglotCase POLYGLOT_KEYS[] = {
+    {"start position", START_FEN, 0x463B96181691FC9CULL},
+    {"e4", "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823C9B50FD114196ULL},
+    {"e4 d5", "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756B94461C50FB0ULL},
+    {"e4 d5 e5", "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662FAFB965DB29D4ULL},
+    {"e4 d5 e5 f5", "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22A48B5A8E47FF78ULL},
+    {"e4 d5 e5 f5 Ke2", "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652A607CA3F242C1ULL},
+    {"e4 d5 e5 f5 Ke2 Kf7", "rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00FDD303C946BDD9ULL},
+    {"a4 b5 h4 b4 c4", "rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3C8123EA7B067637ULL},
+    {"a4 b5 h4 b4 c4 bxc3 Ra3", "rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5C3F9B829B279560ULL},
+};
+
+// a one-entry book holding 1. e4, probed from the starting position
+bool book_probe_passes() {
+    BookEntry entry;
+    entry.key = 0x463B96181691FC9CULL;
+    entry.move = (uint16_t)(4 | (3 << 3) | (4 << 6) | (1 << 9));
+    entry.weight = 1;
+
+    uint8_t bytes[BOOK_ENTRY_SIZE];
+    write_book_entry(entry, bytes);
+    OpeningBook book;
+    Position position;
+    return book.load(bytes, BOOK_ENTRY_SIZE) && parse_fen(START_FEN, position) && move_to_uci(book.probe(position)) == "e2e4";
+}
+
+uint64_t perft(Position &position, int depth) {
+    MoveList moves;
+    generate_moves(position, moves);
+
+    // the moves are legal, so the leaves don't need to be played
+    if (depth <= 1) {
+        return (depth == 1 ? moves.size : 1);
+    }
+
+    uint64_t nodes = 0;
+    for (Move move:moves) {
+        position.make_move(move);
+        nodes += perft(position, depth - 1);
+        position.unmake_move();
+    }
+    return nodes;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void print_speed(uint64_t nodes, double seconds) {
+    printf("%llu nodes in %.3f s (%.0f nodes/s)\n", (unsigned long long)nodes, seconds, nodes / std::max(seconds, 1e-9));
+}
+
+bool setup(const std::string &fen, Position &position) {
+    if (!parse_fen(fen, position)) {
+        fprintf(stderr, "invalid FEN: %s\n", fen.c_str());
+        return false;
+    }
+    return true;
+}
+
+int run_perft(int depth, const std::string &fen) {
+    Position position;
+    if (!setup(fen, position)) return 1;
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = perft(position, depth);
+    print_speed(nodes, seconds_since(start));
+    return 0;
+}
+
+int run_divide(int depth, const std::string &fen) {
+    Position position;
+    if (!setup(fen, position)) return 1;
+
+    MoveList moves;
+    generate_moves(position, moves);
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = 0;
+    for (Move move:moves) {
+        position.make_move(move);
+        uint64_t move_nodes = perft(position, depth - 1);
+        position.unmake_move();
+
+        printf("%s: %llu\n", move_to_uci(move).c_str(), (unsigned long long)move_nodes);
+        nodes += move_nodes;
+    }
+
+    printf("\n%d moves\n", moves.size);
+    print_speed(nodes, seconds_since(start));
+    return 0;
+}
+
+int run_suite() {
+    int failures = 0;
+    uint64_t total_nodes = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const PerftCase &test:PERFT_SUITE) {
+        Position position;
+        if (!setup(test.fen, position)) return 1;
+
+        uint64_t nodes = perft(position, test.depth);
+        total_nodes += nodes;
+
+        bool passed = (nodes == test.nodes);
+        failures += !passed;
+        printf("%s %s (depth %d): %llu", passed ? "ok  " : "FAIL", test.name.c_str(), test.depth, (unsigned long long)nodes);
+        if (!passed) {
+            printf(", expected %llu", (unsigned long long)test.nodes);
+        }
+        printf("\n");
+    }
+
+    double seconds = seconds_since(start);
+
+    for (const auto &[name, fen]:INVALID_FENS) {
+        Position position;
+        bool passed = !parse_fen(fen, position);
+        failures += !passed;
+        printf("%s %s rejected\n", passed ? "ok  " : "FAIL", name.c_str());
+    }
+
+    for (const PolyglotCase &test:POLYGLOT_KEYS) {
+        Position position;
+        if (!setup(test.fen, position)) return 1;
+
+        uint64_t key = polyglot_key(position);
+        bool passed = (key == test.key);
+        failures += !passed;
+        printf("%s Polyglot key of %s: %016llx", passed ? "ok  " : "FAIL", test.name.c_str(), (unsigned long long)key);
+        if (!passed) {
+            printf(", expected %016llx", (unsigned long long)test.key);
+        }
+        printf("\n");
+    }
+
+    bool book_passed = book_probe_passes();
+    failures += !book_passed;
+    printf("%s book probe of the start position\n", book_passed ? "ok  " : "FAIL");
+
+    printf("\n");
+    print_speed(total_nodes, seconds);
+    if (failures > 0) {
+        int total = (int)(sizeof(PERFT_SUITE) / sizeof(PERFT_SUITE[0]) + sizeof(INVALID_FENS) / sizeof(INVALID_FENS[0])
+            + sizeof(POLYGLOT_KEYS) / sizeof(POLYGLOT_KEYS[0])) + 1;
+        printf("%d of %d checks failed\n", failures, total);
+    }
+    return (failures > 0 ? 1 : 0);
+}
+
+void usage() {
+    fprintf(stderr, "usage: perft <depth> [fen]\n       perft divide <depth> [fen]\n       perft suite\n");
+}
+
+int main(int argc, char **argv) {
+    std::string command = (argc > 1 ? argv[1] : "");
+
+    if (command == "suite") {
+        return run_suite();
+    }
+
+    bool divide = (command == "divide");
+    int arg = (divide ? 2 : 1);
+    if (argc <= arg) {
+        usage();
+        return 2;
+    }
+
+    int depth = atoi(argv[arg]);
+    std::string fen = START_FEN;
+    if (argc > arg + 1) { // the FEN may be passed unquoted, as separate arguments
+        fen = "";
+        for (int i = arg + 1; i < argc; i++) {
+            fen += std::string(i > arg + 1 ? " " : "") + argv[i];
+        }
+    }
+
+    return (divide ? run_divide(depth, fen) : run_perft(depth, fen));
+}
@@ -0,0 +1,270 @@
+// native UCI front end, for running the engine from chess GUIs, tournament managers and analysis scripts
+// http://wbec-ridderkerk.nl/html/UCIProtocol.html
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../structs.h"
+#include "../notation.h"
+#include "../strategies.h"
+#include "../transposition_table.h"
+#include "../opening_book.h"
+#include "../endgame_tables.h"
+
+const std::string ENGINE_NAME = "Chess-Engine";
+const int MAX_HASH_MEGABYTES = 4096;
+const int MAX_THREADS = 64;
+const int MOVES_TO_GO = 30; // how many more moves to budget the clock over when the GUI doesn't say
+const int MOVE_OVERHEAD = 50; // milliseconds kept back for communication delays
+
+std::atomic<bool> stop_search(false);
+std::atomic<bool> ponder_hit(false);
+bool debug_mode = false;
+bool own_book = true;
+std::thread search_thread;
+
+void wait_for_search() {
+    if (search_thread.joinable()) {
+        search_thread.join();
+    }
+}
+
+std::string score_string(int score) {
+    if (std::abs(score) >= MATE_BOUND) { // in moves rather than plies, negative when we are being mated
+        int plies = MATE_SCORE - std::abs(score);
+        return "mate " + std::to_string(score > 0 ? (plies + 1) / 2 : -(plies + 1) / 2);
+    }
+    return "cp " + std::to_string(score);
+}
+
+void print_info(const SearchInfo &info) {
+    std::string pv;
+    for (Move move:info.pv) {
+        pv += " " + move_to_uci(move);
+    }
+
+    uint64_t nps = info.nodes * 1000 / std::max(info.millis, 1);
+    printf("info depth %d seldepth %d score %s nodes %llu nps %llu time %d pv%s\n", info.depth, info.stats.selective_depth, score_string(info.score).c_str(),
+        (unsigned long long)info.nodes, (unsigned long long)nps, info.millis, pv.c_str());
+
+    // the rest of the stats, for tuning the search
+    if (debug_mode) {
+        const SearchStats &stats = info.stats;
+        std::string cutoffs;
+        for (double count:stats.cutoffs_by_move) {
+            cutoffs += " " + std::to_string((int)(count * 100 / std::max(stats.beta_cutoffs, 1.0))) + "%";
+        }
+        printf("info string qnodes %.0f branching %.2f cutoffs %.0f by move%s tthits %.0f/%.0f movegen %.0fms eval %.0fms legality %.0fms\n",
+            stats.quiescence_nodes, stats.branching_factor, stats.beta_cutoffs, cutoffs.c_str(), stats.tt_hits, stats.tt_probes,
+            stats.move_generation_millis, stats.evaluation_millis, stats.legality_millis);
+    }
+    fflush(stdout);
+}
+
+// position [startpos | fen <fen>] [moves <move>...]
+void set_position(Position &position, std::istringstream &command) {
+    std::string token, fen;
+    command >> token;
+
+    if (token == "startpos") {
+        fen = START_FEN;
+        command >> token;
+    }
+    else if (token == "fen") {
+        while (command >> token && token != "moves") {
+            fen += token + " ";
+        }
+    }
+
+    Position new_position;
+    if (!parse_fen(fen, new_position)) {
+        printf("info string invalid position\n");
+        return;
+    }
+
+    if (token == "moves") {
+        while (command >> token) {
+            Move move = parse_uci_move(new_position, token);
+            if (move == NO_MOVE) {
+                printf("info string illegal move %s\n", token.c_str());
+                break;
+            }
+            new_position.make_move(move);
+        }
+    }
+
+    position = new_position;
+}
+
+// go [depth <plies>] [movetime <ms>] [wtime <ms>] [btime <ms>] [winc <ms>] [binc <ms>] [movestogo <moves>] [infinite] [ponder]
+void go(const Position &position, std::istringstream &command) {
+    int depth = MAX_DEPTH;
+    int movetime = 0;
+    int time_left[2] = {0, 0};
+    int increment[2] = {0, 0};
+    int moves_to_go = MOVES_TO_GO;
+    bool ponder = false;
+    bool infinite = false;
+
+    std::string token;
+    while (command >> token) {
+        if (token == "depth") command >> depth;
+        else if (token == "movetime") command >> movetime;
+        else if (token == "wtime") command >> time_left[WHITE];
+        else if (token == "btime") command >> time_left[BLACK];
+        else if (token == "winc") command >> increment[WHITE];
+        else if (token == "binc") command >> increment[BLACK];
+        else if (token == "movestogo") command >> moves_to_go;
+        else if (token == "ponder") ponder = true;
+        else if (token == "infinite") infinite = true;
+    }
+
+    // spend an even share of the clock, plus most of the increment; infinite and depth searches leave millis at 0
+    int millis = movetime;
+    int us = position.side_to_move;
+    if (millis == 0 && time_left[us] > 0) {
+        millis = time_left[us] / std::max(moves_to_go, 1) + increment[us] * 3 / 4;
+        millis = std::max(std::min(millis, time_left[us] - MOVE_OVERHEAD), 1);
+    }
+
+    // the book only answers when asked for a move rather than for analysis, and not while pondering,
+    // as the move may not be printed before the ponder hit
+    Position book_position = position;
+    Move book_move = (own_book && depth == MAX_DEPTH && !infinite && !ponder ? opening_book.probe(book_position) : NO_MOVE);
+    if (book_move != NO_MOVE) {
+        printf("info string book move\nbestmove %s\n", move_to_uci(book_move).c_str());
+        return;
+    }
+
+    stop_search = false;
+    ponder_hit = false;
+    search_thread = std::thread([position, depth, millis, ponder, infinite]() {
+        Position search_position = position;
+        Move best_move = iterative_deepening(search_position, std::clamp(depth, 1, MAX_DEPTH), millis, nullptr, ponder);
+
+        // a search that ends early (on a mate, or at MAX_DEPTH) may not answer before the GUI asks: an infinite one waits for stop,
+        // and a ponder search for the GUI to say whether the opponent played the move
+        while ((infinite || (ponder && !ponder_hit)) && !stop_search) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        if (best_move == NO_MOVE) {
+            printf("bestmove 0000\n");
+        }
+        else { // suggest the move to ponder on next
+            std::vector<Move> pv = principal_variation(search_position, transposition_table, best_move, 2);
+            printf("bestmove %s%s\n", move_to_uci(best_move).c_str(), pv.size() > 1 ? (" ponder " + move_to_uci(pv[1])).c_str() : "");
+        }
+        fflush(stdout);
+    });
+}
+
+// setoption name <name> value <value>
+void set_option(std::istringstream &command) {
+    std::string token, name, value;
+    command >> token; // "name"
+    while (command >> token && token != "value") {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    std::getline(command >> std::ws, value); // paths may contain spaces
+
+    if (name == "Hash") {
+        transposition_table.resize(std::clamp(atoi(value.c_str()), 1, MAX_HASH_MEGABYTES));
+    }
+    else if (name == "Threads") {
+        set_threads(atoi(value.c_str()));
+    }
+    else if (name == "OwnBook") {
+        own_book = (value == "true");
+    }
+    else if (name == "Ponder") { // the GUI decides when to ponder, so there is nothing to set
+    }
+    else if (name == "BookFile") {
+        if (!opening_book.open(value)) {
+            printf("info string can't open book %s\n", value.c_str());
+        }
+    }
+    else {
+        printf("info string unknown option %s\n", name.c_str());
+    }
+}
+
+int main() {
+    stop_requested_hook = []() {
+        return stop_search.load();
+    };
+    iteration_hook = print_info;
+    ponder_hit_hook = []() {
+        return ponder_hit.load();
+    };
+
+    // builds the endgame tables while the GUI sets up, rather than on the clock of the first endgame search
+    std::thread(init_endgame_tables).detach();
+
+    Position position;
+    parse_fen(START_FEN, position);
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream command(line);
+        std::string token;
+        command >> token;
+
+        if (token == "uci") {
+            printf("id name %s\n", ENGINE_NAME.c_str());
+            printf("id author User0149\n");
+            printf("option name Hash type spin default %d min 1 max %d\n", (int)DEFAULT_HASH_MEGABYTES, MAX_HASH_MEGABYTES);
+            printf("option name Threads type spin default 1 min 1 max %d\n", MAX_THREADS);
+            printf("option name OwnBook type check default true\n");
+            printf("option name BookFile type string default <empty>\n");
+            printf("option name Ponder type check default false\n");
+            printf("uciok\n");
+        }
+        else if (token == "debug") { // debug on|off
+            command >> token;
+            debug_mode = (token == "on");
+        }
+        else if (token == "isready") {
+            init_endgame_tables(); // waits for the startup build to finish
+            printf("readyok\n");
+        }
+        else if (token == "ucinewgame") {
+            wait_for_search();
+            transposition_table.clear();
+        }
+        else if (token == "setoption") {
+            wait_for_search();
+            set_option(command);
+        }
+        else if (token == "position") {
+            wait_for_search();
+            set_position(position, command);
+        }
+        else if (token == "go") {
+            wait_for_search();
+            go(position, command);
+        }
+        else if (token == "ponderhit") { // the opponent played the move being pondered on: carry on, now against the clock
+            ponder_hit = true;
+        }
+        else if (token == "stop") {
+            stop_search = true;
+            wait_for_search();
+        }
+        else if (token == "quit") {
+            break;
+        }
+        fflush(stdout);
+    }
+
+    stop_search = true;
+    wait_for_search();
+    return 0;
+}
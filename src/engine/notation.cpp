@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <sstream>
+#include <cctype>
+
+#include "notation.h"
+#include "attacks.h"
+#include "utils.h"
+#include "possible_moves.h"
+#include "game_helper_funcs.h"
+
+const std::string PIECE_LETTERS = "pnbrqk";
+
+bool finish_setup(Position &position) {
+    if (pop_count(position.pieces[WHITE][KING]) != 1 || pop_count(position.pieces[BLACK][KING]) != 1) {
+        return false;
+    }
+
+    // pawns can't stand on the back ranks, and the side that just moved can't have left its king in check
+    if ((position.pieces[WHITE][PAWN] | position.pieces[BLACK][PAWN]) & (RANK_1 | RANK_8)) {
+        return false;
+    }
+    if (is_attacked(position, position.king_square(position.side_to_move ^ 1), position.side_to_move)) {
+        return false;
+    }
+
+    // drop any right whose king or rook isn't on its starting square, so castling generation can rely on them being there
+    const int CASTLING_SQUARES[4][3] = {{WHITE, 4, 7}, {WHITE, 4, 0}, {BLACK, 60, 63}, {BLACK, 60, 56}};
+    for (int i = 0; i < 4; i++) {
+        int color = CASTLING_SQUARES[i][0];
+        if (!(position.pieces[color][KING] & square_bit(CASTLING_SQUARES[i][1])) || !(position.pieces[color][ROOK] & square_bit(CASTLING_SQUARES[i][2]))) {
+            position.castling_rights &= ~(1 << i);
+        }
+    }
+
+    // like make_move, only remember the en passant square if the capture is actually possible
+    int us = position.side_to_move;
+    int square = position.en_passant;
+    if (square != NO_SQUARE) {
+        int pushed_pawn = square + (us == WHITE ? -8 : 8);
+        if (rank_of(square) != (us == WHITE ? 5 : 2) || !(position.pieces[us ^ 1][PAWN] & square_bit(pushed_pawn)) ||
+            !(pawn_attacks(us ^ 1, square) & position.pieces[us][PAWN])) {
+            position.en_passant = NO_SQUARE;
+        }
+    }
+
+    position.key = position.compute_key();
+    return true;
+}
+
+bool parse_fen(const std::string &fen, Position &position) {
+    std::istringstream fields(fen);
+    std::string placement, side, castling, en_passant;
+    int halfmove_clock = 0;
+    int fullmove_number = 1;
+
+    if (!(fields >> placement >> side >> castling >> en_passant)) {
+        return false;
+    }
+    fields >> halfmove_clock >> fullmove_number;
+
+    position = Position();
+
+    // pieces, from a8 to h1
+    int file = 0;
+    int rank = 7;
+    for (char c:placement) {
+        if (c == '/') {
+            if (file != 8 || rank == 0) return false;
+            file = 0;
+            rank--;
+        }
+        else if ('1' <= c && c <= '8') {
+            file += c - '0';
+            if (file > 8) return false;
+        }
+        else {
+            size_t piece_type = PIECE_LETTERS.find((char)std::tolower(c));
+            if (piece_type == std::string::npos || file > 7) return false;
+
+            position.put_piece(std::isupper(c) ? WHITE : BLACK, (int)piece_type, make_square(file, rank));
+            file++;
+        }
+    }
+    if (file != 8 || rank != 0) {
+        return false;
+    }
+
+    if (side != "w" && side != "b") {
+        return false;
+    }
+    position.side_to_move = (side == "w" ? WHITE : BLACK);
+
+    if (castling != "-") {
+        for (char c:castling) {
+            switch (c) {
+                case 'K': position.castling_rights |= WHITE_KINGSIDE; break;
+                case 'Q': position.castling_rights |= WHITE_QUEENSIDE; break;
+                case 'k': position.castling_rights |= BLACK_KINGSIDE; break;
+                case 'q': position.castling_rights |= BLACK_QUEENSIDE; break;
+                default: return false;
+            }
+        }
+    }
+
+    if (en_passant != "-") {
+        if (en_passant.size() != 2 || en_passant[0] < 'a' || en_passant[0] > 'h' || (en_passant[1] != '3' && en_passant[1] != '6')) {
+            return false;
+        }
+
+        position.en_passant = make_square(en_passant[0] - 'a', en_passant[1] - '1');
+    }
+
+    position.halfmove_clock = halfmove_clock;
+    position.moves = 2 * (std::max(fullmove_number, 1) - 1) + position.side_to_move;
+
+    return finish_setup(position);
+}
+
+// the first four FEN fields, which EPD shares
+static std::string fen_fields(const Position &position) {
+    std::string fen;
+
+    for (int rank = 7; rank >= 0; rank--) {
+        int empty = 0;
+        for (int file = 0; file <= 7; file++) {
+            int square = make_square(file, rank);
+            if (position.board[square] == NO_PIECE_TYPE) {
+                empty++;
+                continue;
+            }
+
+            if (empty) {
+                fen += (char)('0' + empty);
+                empty = 0;
+            }
+            char letter = PIECE_LETTERS[position.board[square]];
+            fen += (position.color_on(square) == WHITE ? (char)std::toupper(letter) : letter);
+        }
+        if (empty) {
+            fen += (char)('0' + empty);
+        }
+        if (rank) {
+            fen += '/';
+        }
+    }
+
+    fen += (position.side_to_move == WHITE ? " w " : " b ");
+
+    const char CASTLING_LETTERS[4] = {'K', 'Q', 'k', 'q'};
+    std::string castling;
+    for (int i = 0; i < 4; i++) {
+        if (position.castling_rights & (1 << i)) {
+            castling += CASTLING_LETTERS[i];
+        }
+    }
+    fen += (castling.empty() ? "-" : castling);
+
+    fen += " " + (position.en_passant == NO_SQUARE ? "-" : square_name(position.en_passant));
+    return fen;
+}
+
+std::string to_fen(const Position &position) {
+    return fen_fields(position) + " " + std::to_string(position.halfmove_clock) + " " + std::to_string(position.moves / 2 + 1);
+}
+
+bool parse_epd(const std::string &epd, Position &position, std::map<std::string, std::string> &operations) {
+    std::istringstream fields(epd);
+    std::string placement, side, castling, en_passant;
+    if (!(fields >> placement >> side >> castling >> en_passant)) {
+        return false;
+    }
+
+    // operations are "opcode operand...;", and operands may be quoted strings containing semicolons
+    operations.clear();
+    std::string rest;
+    std::getline(fields, rest);
+
+    size_t i = 0;
+    while (i < rest.size()) {
+        while (i < rest.size() && std::isspace((unsigned char)rest[i])) i++;
+        if (i == rest.size()) break;
+
+        size_t opcode_end = i;
+        while (opcode_end < rest.size() && !std::isspace((unsigned char)rest[opcode_end]) && rest[opcode_end] != ';') opcode_end++;
+        std::string opcode = rest.substr(i, opcode_end - i);
+        if (!std::isalpha((unsigned char)opcode[0])) {
+            return false;
+        }
+
+        std::string operand;
+        bool quoted = false;
+        for (i = opcode_end; i < rest.size() && (quoted || rest[i] != ';'); i++) {
+            if (rest[i] == '"') quoted = !quoted;
+            operand += rest[i];
+        }
+        if (i == rest.size()) { // every operation ends with a semicolon
+            return false;
+        }
+        i++;
+
+        size_t first = operand.find_first_not_of(' ');
+        operations[opcode] = (first == std::string::npos ? "" : operand.substr(first, operand.find_last_not_of(' ') - first + 1));
+    }
+
+    // the clocks are operations in EPD
+    std::string fen = placement + " " + side + " " + castling + " " + en_passant;
+    fen += " " + (operations.count("hmvc") ? operations["hmvc"] : "0");
+    fen += " " + (operations.count("fmvn") ? operations["fmvn"] : "1");
+    return parse_fen(fen, position);
+}
+
+std::string to_epd(const Position &position, const std::map<std::string, std::string> &operations) {
+    std::string epd = fen_fields(position);
+    for (auto [opcode, operand]:operations) {
+        epd += " " + opcode + (operand.empty() ? "" : " " + operand) + ";";
+    }
+    return epd;
+}
+
+std::string square_name(int square) {
+    return {(char)('a' + file_of(square)), (char)('1' + rank_of(square))};
+}
+
+std::string move_to_uci(Move move) {
+    std::string uci = square_name(move.source()) + square_name(move.dest());
+    if (move.is_promotion()) {
+        uci += PIECE_LETTERS[move.promotion()];
+    }
+    return uci;
+}
+
+Move parse_uci_move(Position &position, const std::string &uci) {
+    MoveList moves;
+    generate_moves(position, moves);
+
+    for (Move move:moves) {
+        if (move_to_uci(move) == uci) {
+            return move;
+        }
+    }
+    return NO_MOVE;
+}
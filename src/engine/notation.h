@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <map>
+
+#include "structs.h"
+
+const std::string START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// checks a position built from outside data has one king each, drops castling rights and en passant squares it can't use,
+// and computes its key; returns false if the position can't be played from
+bool finish_setup(Position &position);
+
+// sets up the position described by a FEN string; returns false if the string is malformed
+// the halfmove and fullmove fields may be left out
+bool parse_fen(const std::string &fen, Position &position);
+std::string to_fen(const Position &position);
+
+// EPD is FEN without the clocks, followed by "opcode operand;" operations such as bm, id and the hmvc/fmvn clocks
+bool parse_epd(const std::string &epd, Position &position, std::map<std::string, std::string> &operations);
+std::string to_epd(const Position &position, const std::map<std::string, std::string> &operations = {});
+
+// long algebraic notation, as used by UCI: e2e4, e1g1, e7e8q
+std::string square_name(int square);
+std::string move_to_uci(Move move);
+
+// the legal move with that name in the position, or NO_MOVE if there is none
+Move parse_uci_move(Position &position, const std::string &uci);
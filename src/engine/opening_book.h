@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "structs.h"
+
+const int BOOK_ENTRY_SIZE = 16;
+
+// one entry of a Polyglot .bin book: 16 big-endian bytes, sorted by key, with positions keyed by polyglot_key
+// so books made by other tools work as well as those from native/make_book.cpp
+struct BookEntry {
+    uint64_t key = 0;
+    uint16_t move = 0; // destination file in bits 0-2, rank in 3-5, source file in 6-8, rank in 9-11, promotion in 12-14
+    uint16_t weight = 0;
+    uint32_t learn = 0;
+};
+
+// the position's key in Polyglot's own hashing, which books use instead of Position::key
+uint64_t polyglot_key(const Position &position);
+
+BookEntry read_book_entry(const uint8_t *bytes);
+void write_book_entry(const BookEntry &entry, uint8_t *bytes);
+
+// the Polyglot move code of a move; castling is written as the king capturing its own rook
+uint16_t to_book_move(Move move);
+
+struct OpeningBook {
+    const uint8_t *data = nullptr;
+    size_t entry_count = 0;
+
+    void *mapping = nullptr; // natively the file is memory-mapped rather than read
+    size_t mapping_size = 0;
+    std::vector<uint8_t> bytes; // a book handed over in memory, as in the Wasm build
+
+    ~OpeningBook();
+
+    // replace the current book, if any; false if the file can't be read or isn't a whole number of entries
+    bool open(const std::string &path);
+    bool load(const uint8_t *book_bytes, size_t size);
+    void close();
+
+    // a legal book move for the position, picked at random in proportion to the weights, or NO_MOVE
+    Move probe(Position &position) const;
+};
+
+extern OpeningBook opening_book;
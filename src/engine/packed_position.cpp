@@ -0,0 +1,67 @@
+#include <algorithm>
+
+#include "packed_position.h"
+#include "notation.h"
+#include "utils.h"
+
+PackedPosition pack_position(const Position &position) {
+    PackedPosition packed;
+    uint8_t *bytes = packed.bytes;
+
+    uint64_t occupied = position.occupied();
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (uint8_t)(occupied >> (8 * i));
+    }
+
+    for (int index = 0; occupied; index++) {
+        int square = pop_lsb(occupied);
+        int code = position.color_on(square) * 6 + position.board[square];
+        bytes[8 + index / 2] |= (uint8_t)(code << (4 * (index & 1)));
+    }
+
+    int fullmove_number = position.moves / 2 + 1;
+    bytes[24] = (uint8_t)(position.side_to_move | (position.castling_rights << 1));
+    bytes[25] = (uint8_t)position.en_passant;
+    bytes[26] = (uint8_t)std::min(position.halfmove_clock, 255);
+    bytes[27] = (uint8_t)fullmove_number;
+    bytes[28] = (uint8_t)(fullmove_number >> 8);
+    bytes[29] = (uint8_t)((position.castling_advantage[WHITE] + 1) | ((position.castling_advantage[BLACK] + 1) << 2));
+
+    return packed;
+}
+
+bool unpack_position(const uint8_t *bytes, Position &position) {
+    uint64_t occupied = 0;
+    for (int i = 0; i < 8; i++) {
+        occupied |= (uint64_t)bytes[i] << (8 * i);
+    }
+    if (pop_count(occupied) > 32) {
+        return false;
+    }
+
+    position = Position();
+
+    for (int index = 0; occupied; index++) {
+        int square = pop_lsb(occupied);
+        int code = (bytes[8 + index / 2] >> (4 * (index & 1))) & 15;
+        if (code >= 12) {
+            return false;
+        }
+        position.put_piece(code / 6, code % 6, square);
+    }
+
+    position.side_to_move = bytes[24] & 1;
+    position.castling_rights = (bytes[24] >> 1) & 15;
+    position.en_passant = std::min((int)bytes[25], NO_SQUARE);
+    position.halfmove_clock = bytes[26];
+
+    int fullmove_number = bytes[27] | (bytes[28] << 8);
+    position.moves = 2 * (std::max(fullmove_number, 1) - 1) + position.side_to_move;
+
+    for (int color:{WHITE, BLACK}) {
+        int advantage = ((bytes[29] >> (2 * color)) & 3) - 1;
+        position.castling_advantage[color] = std::clamp(advantage, -1, 1);
+    }
+
+    return finish_setup(position);
+}
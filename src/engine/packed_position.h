@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+#include "structs.h"
+
+const int PACKED_POSITION_SIZE = 32;
+
+// fixed-size binary position for storage and IPC, little-endian throughout:
+// bytes 0-7    occupied squares bitboard
+// bytes 8-23   4-bit piece codes (color * 6 + piece type) of the occupied squares from a1 upwards, low nibble first
+// byte 24      side to move in bit 0, castling rights in bits 1-4
+// byte 25      en passant square, or NO_SQUARE
+// byte 26      halfmove clock
+// bytes 27-28  fullmove number
+// byte 29      castling advantage of each side plus one, white in bits 0-1 and black in bits 2-3
+// bytes 30-31  zero
+struct PackedPosition {
+    uint8_t bytes[PACKED_POSITION_SIZE] = {};
+};
+
+PackedPosition pack_position(const Position &position);
+
+// sets up a position from PACKED_POSITION_SIZE bytes; returns false if they don't describe a playable position
+bool unpack_position(const uint8_t *bytes, Position &position);
@@ -1,314 +1,307 @@
-#include <emscripten/bind.h>
-
 #include <chrono>
 #include <random>
 #include <algorithm>
 
+#include "possible_moves.h"
 #include "game_helper_funcs.h"
+#include "attacks.h"
+#include "search_stats.h"
 #include "utils.h"
 
-using namespace emscripten;
-
-// non-castling and non-pawn moves
-std::vector<PossibleMove> normal_piece_moves(const GameState &game_state, Piece piece, Square square) {
-    Coordinate piece_coords = square_to_coord(square);
-
-    std::vector<PossibleMove> allowed_moves;
+MoveGenInfo move_gen_info(const Position &position) {
+    PROFILE_SCOPE(move_generation_millis);
+    int us = position.side_to_move;
+    int them = us ^ 1;
+    uint64_t occupied = position.occupied();
 
-    // this piece attacks "normally"
-    // keep moving in one direction until we are blocked
-    for (Coordinate direction:piece.attack_directions()) {
-        for (int r = 1; r <= piece.attack_range(); r++) {
-            int dest_i = piece_coords.i + (r * direction.i);
-            int dest_j = piece_coords.j + (r * direction.j);
+    MoveGenInfo info;
+    info.king = position.king_square(us);
+    info.checkers = attackers_to(position, info.king, them, occupied);
 
-            if (!valid_coord({dest_i, dest_j})) {
-                break;
-            }
-            
-            Piece dest_piece = game_state.board_state[dest_i][dest_j];
-            if (dest_piece.active && dest_piece.color == game_state.to_move) { // can't move past a friendly piece
-                break;
-            }
+    if (info.checkers == 0) {
+        info.check_mask = ~0ULL;
+    }
+    else if (pop_count(info.checkers) == 1) { // capture the checker or block the check
+        info.check_mask = info.checkers | between_squares(info.king, lsb(info.checkers));
+    }
+    else { // double check: only the king can move
+        info.check_mask = 0;
+    }
 
-            // we can move to this square (ignoring king checks)
-            GameState new_game_state = game_state;
+    // enemy sliders that would attack our king if our own pieces were out of the way
+    uint64_t snipers = (bishop_attacks(info.king, position.colors[them]) & (position.pieces[them][BISHOP] | position.pieces[them][QUEEN])) |
+        (rook_attacks(info.king, position.colors[them]) & (position.pieces[them][ROOK] | position.pieces[them][QUEEN]));
+    while (snipers) {
+        uint64_t blockers = between_squares(info.king, pop_lsb(snipers)) & occupied;
+        if (pop_count(blockers) == 1 && (blockers & position.colors[us])) {
+            info.pinned |= blockers;
+        }
+    }
 
-            new_game_state.moves = game_state.moves + 1;
-            if (dest_piece.active && dest_piece.color != game_state.to_move) {
-                new_game_state.last_capture_or_pawn_move = game_state.moves + 1;
-            }
+    return info;
+}
 
-            // move piece
-            new_game_state.board_state[piece_coords.i][piece_coords.j].active = false;
-            new_game_state.board_state[dest_i][dest_j] = piece;
-            new_game_state.board_state[dest_i][dest_j].moves = piece.moves + 1;
-            new_game_state.board_state[dest_i][dest_j].last_move_index = game_state.moves + 1;
+// do the three squares lie on one line?
+static bool aligned(int a, int b, int c) {
+    return (file_of(b) - file_of(a)) * (rank_of(c) - rank_of(a)) == (file_of(c) - file_of(a)) * (rank_of(b) - rank_of(a));
+}
 
-            new_game_state.previous_states[new_game_state.hash()]++;
+bool is_legal(Position &position, const MoveGenInfo &info, Move move) {
+    PROFILE_SCOPE(legality_millis);
+    int source = move.source();
+    int them = position.side_to_move ^ 1;
 
-            if (piece.type == "king" && piece.moves == 0) {
-                (game_state.to_move == "white" ? new_game_state.castling_advantage_white : new_game_state.castling_advantage_black) = -1.0;
-            }
+    if (source == info.king) {
+        if (move.flags() == KING_CASTLE || move.flags() == QUEEN_CASTLE) { // castling_moves has checked every square
+            return true;
+        }
+        // take the king off the board, so it can't hide from a slider behind itself
+        return !attackers_to(position, move.dest(), them, position.occupied() ^ square_bit(source));
+    }
 
-            if (!is_targeted(new_game_state, king_square(new_game_state))) { // we don't put our king in check, so this move is valid
-                new_game_state.to_move = game_state.to_move == "white" ? "black" : "white";
+    if (move.flags() == EN_PASSANT) { // removes two pawns from a line at once, so just play it and look
+        position.make_move(move);
+        bool legal = !is_attacked(position, info.king, them);
+        position.unmake_move();
+        return legal;
+    }
 
-                Move move = {square, coord_to_square({dest_i, dest_j}), piece.type};
-                allowed_moves.push_back({move, new_game_state});
-            }
+    // a pinned piece may only move along the pin
+    return !(info.pinned & square_bit(source)) || aligned(info.king, source, move.dest());
+}
 
-            if (dest_piece.active && dest_piece.color != game_state.to_move) { // opponent is on this square, so we can't move any further
-                break;
-            }
-        }
+// non-castling and non-pawn moves
+void normal_piece_moves(Position &position, const MoveGenInfo &info, int square, MoveList &moves, GenType type) {
+    int piece_type = position.board[square];
+    uint64_t occupied = position.occupied();
+
+    uint64_t targets = 0;
+    switch (piece_type) {
+        case KNIGHT: targets = knight_attacks(square); break;
+        case BISHOP: targets = bishop_attacks(square, occupied); break;
+        case ROOK: targets = rook_attacks(square, occupied); break;
+        case QUEEN: targets = queen_attacks(square, occupied); break;
+        case KING: targets = king_attacks(square); break;
+    }
+    targets &= ~position.colors[position.side_to_move]; // can't move onto a friendly piece
+    if (piece_type != KING) {
+        targets &= info.check_mask;
+    }
+    if (type == GEN_NOISY) {
+        targets &= position.colors[position.side_to_move ^ 1];
+    }
+    else if (type == GEN_QUIET) {
+        targets &= ~occupied;
     }
 
-    return allowed_moves;
+    while (targets) {
+        int dest = pop_lsb(targets);
+        moves.push_back(Move(square, dest, position.board[dest] != NO_PIECE_TYPE ? CAPTURE : QUIET));
+    }
 }
 
-std::vector<PossibleMove> castling_moves(const GameState &game_state, Piece king, Square king_pos_square) {
-    Coordinate king_coord = square_to_coord(king_pos_square);
+void castling_moves(Position &position, const MoveGenInfo &info, MoveList &moves) {
+    int rank = (position.side_to_move == WHITE ? 0 : 7);
+    int king_pos = make_square(4, rank);
 
-    std::vector<PossibleMove> allowed_moves;
+    if (info.king != king_pos || info.checkers) {
+        return;
+    }
+
+    for (int rook_file:{0, 7}) { // test for queen- and kingside castling
+        int right = (rook_file == 7 ? WHITE_KINGSIDE : WHITE_QUEENSIDE) << (position.side_to_move == WHITE ? 0 : 2);
+        if (!(position.castling_rights & right)) {
+            continue;
+        }
+
+        int king_dest_file = (rook_file == 0 ? 2 : 6);
+        bool can_castle = true;
 
-    for (char rook_file:{'a', 'h'}) { // test for queen- and kingside castling
-        Coordinate rook_square_coord = square_to_coord({std::string(1, rook_file), king_pos_square.rank});
-        Piece rook_square_piece = game_state.board_state[rook_square_coord.i][rook_square_coord.j];
-
-        Square king_dest_square = {(rook_file == 'a' ? "c": "g"), king_pos_square.rank};
-        Coordinate king_dest_coord = square_to_coord(king_dest_square);
-        
-        if (rook_square_piece.active && rook_square_piece.last_move_index == 0) { // rook hasn't moved: try castling
-
-            bool can_castle = !is_targeted(game_state, king_pos_square);
-            for (char file = std::min(rook_file, 'e') + 1; file <= std::max(rook_file, 'e') - 1; file++) { // check for pieces blocking the castling path
-                Square in_between_square = {std::string(1, file), king_pos_square.rank};
-                Coordinate in_between_coord = square_to_coord(in_between_square);
-                if (game_state.board_state[in_between_coord.i][in_between_coord.j].active) {
-                    can_castle = false;
-                }
+        for (int file = std::min(rook_file, 4) + 1; file <= std::max(rook_file, 4) - 1; file++) { // check for pieces blocking the castling path
+            if (position.board[make_square(file, rank)] != NO_PIECE_TYPE) {
+                can_castle = false;
             }
-            for (char file = std::min('e', king_dest_square.file[0]); file <= std::max('e', king_dest_square.file[0]); file++) { // check if king will be checked
-                Square in_between_square = {std::string(1, file), king_pos_square.rank};
-                if (is_targeted(game_state, in_between_square)) {
-                    can_castle = false;
-                }
+        }
+        for (int file = std::min(4, king_dest_file); file <= std::max(4, king_dest_file); file++) { // check if king will be checked
+            if (is_targeted(position, make_square(file, rank))) {
+                can_castle = false;
             }
+        }
 
-            if (can_castle) { // we can castle
-                GameState new_game_state = game_state;
-
-                new_game_state.moves = game_state.moves + 1;
-                (game_state.to_move == "white" ? new_game_state.castling_advantage_white : new_game_state.castling_advantage_black) = 1.0;
-                new_game_state.last_capture_or_pawn_move = game_state.last_capture_or_pawn_move; // castling is not a capture nor a pawn move
-
-                // move king
-                new_game_state.board_state[king_coord.i][king_coord.j].active = false;
-                new_game_state.board_state[king_dest_coord.i][king_dest_coord.j] = king;
-                new_game_state.board_state[king_dest_coord.i][king_dest_coord.j].last_move_index = game_state.moves + 1;
-                new_game_state.board_state[king_dest_coord.i][king_dest_coord.j].moves = king.moves + 1;
-
-                // move rook
-                Coordinate rook_dest_coord = square_to_coord({std::string(1, rook_file == 'a' ? 'd': 'f'), king_pos_square.rank});
-                new_game_state.board_state[rook_square_coord.i][rook_square_coord.j].active = false;
-                new_game_state.board_state[rook_dest_coord.i][rook_dest_coord.j] = rook_square_piece;
-                new_game_state.board_state[rook_dest_coord.i][rook_dest_coord.j].last_move_index = game_state.moves + 1;
-                
-                new_game_state.previous_states[new_game_state.hash()]++;
-
-                if (!is_targeted(new_game_state, king_square(new_game_state))) { // i don't see how our king can be targeted if it doesn't step through targeted squares but let's include this check anyway
-                    new_game_state.to_move = game_state.to_move == "white" ? "black" : "white";
-
-                    Move move = {king_pos_square, king_dest_square, "king"};
-                    allowed_moves.push_back({move, new_game_state});
-                }
-            }
+        if (can_castle) {
+            moves.push_back(Move(king_pos, make_square(king_dest_file, rank), rook_file == 7 ? KING_CASTLE : QUEEN_CASTLE));
         }
     }
-
-    return allowed_moves;
 }
 
-std::vector<PossibleMove> pawn_non_en_passant_moves(const GameState &game_state, Piece pawn, Square pawn_square) {
-    Coordinate pawn_coord = square_to_coord(pawn_square);
-    int move_direction_rank = (pawn.color == "white" ? 1 : -1);
+void pawn_moves(Position &position, const MoveGenInfo &info, int square, MoveList &moves, GenType type) {
+    int us = position.side_to_move;
+    int forward = (us == WHITE ? 8 : -8);
+    uint64_t occupied = position.occupied();
 
-    std::vector<PossibleMove> allowed_moves;
-
-    std::vector<Coordinate> potential_dest_coords;
+    Move candidate_moves[4]; // flags of these moves are filled in as if they weren't promotions
+    int move_count = 0;
 
     // add forward moves
-    Square forward_1_square = {pawn_square.file, std::string(1, pawn_square.rank[0] + move_direction_rank)};
-    Coordinate forward_1_coord = square_to_coord(forward_1_square);
-    if (!game_state.board_state[forward_1_coord.i][forward_1_coord.j].active) { // can move forward one square
-        potential_dest_coords.push_back(forward_1_coord);
-
-        Square forward_2_square = {pawn_square.file, std::string(1, pawn_square.rank[0] + 2*move_direction_rank)};
-        Coordinate forward_2_coord = square_to_coord(forward_2_square);
-        if (pawn.last_move_index == 0 && !game_state.board_state[forward_2_coord.i][forward_2_coord.j].active) { // first move and can move 2 squares forward
-            potential_dest_coords.push_back(forward_2_coord);
-        }
-    }
-    
-    // add capture moves
-    std::vector<Coordinate> capture_coords = {
-        square_to_coord({
-            std::string(1, pawn_square.file[0] - 1),
-            std::string(1, pawn_square.rank[0] + move_direction_rank)
-        }), 
-        square_to_coord({
-            std::string(1, pawn_square.file[0] + 1),
-            std::string(1, pawn_square.rank[0] + move_direction_rank)
-        })
-    };
-
-    for (Coordinate capture_coord:capture_coords) {
-        if (valid_coord(capture_coord) && game_state.board_state[capture_coord.i][capture_coord.j].color != game_state.to_move && game_state.board_state[capture_coord.i][capture_coord.j].active) {
-            potential_dest_coords.push_back(capture_coord);
+    int forward_1 = square + forward;
+    if (!(occupied & square_bit(forward_1))) { // can move forward one square
+        candidate_moves[move_count++] = Move(square, forward_1);
+
+        int forward_2 = forward_1 + forward;
+        if (rank_of(square) == (us == WHITE ? 1 : 6) && !(occupied & square_bit(forward_2))) { // first move and can move 2 squares forward
+            candidate_moves[move_count++] = Move(square, forward_2, DOUBLE_PAWN_PUSH);
         }
     }
 
-    // test if the found moves are possible
-    for (Coordinate dest_coord:potential_dest_coords) {
-        Square dest_square = coord_to_square(dest_coord);
-
-        std::vector<std::string> new_piece_types = ((dest_square.rank == "1" || dest_square.rank == "8") ? (std::vector<std::string>){"queen", "rook", "bishop", "knight"} : (std::vector<std::string>){"pawn"});
-        
-        for (std::string new_piece_type:new_piece_types) {
-            Piece dest_piece = game_state.board_state[dest_coord.i][dest_coord.j];
-            GameState new_game_state = game_state;
-
-            new_game_state.moves = game_state.moves + 1;
-            new_game_state.last_capture_or_pawn_move = game_state.moves + 1;
-
-            
-            // move piece
-            new_game_state.board_state[pawn_coord.i][pawn_coord.j].active = false;
-            new_game_state.board_state[dest_coord.i][dest_coord.j] = pawn;
-            new_game_state.board_state[dest_coord.i][dest_coord.j].type = new_piece_type;
-            new_game_state.board_state[dest_coord.i][dest_coord.j].last_move_index = game_state.moves + 1;
-            new_game_state.board_state[dest_coord.i][dest_coord.j].moves = pawn.moves + 1;
+    // add capture moves, including en passant
+    uint64_t capturable = position.colors[us ^ 1];
+    if (position.en_passant != NO_SQUARE) {
+        capturable |= square_bit(position.en_passant);
+    }
+    uint64_t captures = pawn_attacks(us, square) & capturable;
+    while (captures) {
+        int dest = pop_lsb(captures);
+        candidate_moves[move_count++] = Move(square, dest, dest == position.en_passant ? EN_PASSANT : CAPTURE);
+    }
 
-            new_game_state.previous_states[new_game_state.hash()]++;
+    for (int i = 0; i < move_count; i++) {
+        Move move = candidate_moves[i];
+        if (move.flags() != EN_PASSANT && !(info.check_mask & square_bit(move.dest()))) { // en passant is checked in full by is_legal
+            continue;
+        }
 
-            if (!is_targeted(new_game_state, king_square(new_game_state))) { // we don't put our king in check, so this move is valid
-                new_game_state.to_move = game_state.to_move == "white" ? "black" : "white";
+        bool promotion = (rank_of(move.dest()) == (us == WHITE ? 7 : 0));
+        if (type == GEN_NOISY && !promotion && !move.is_capture()) {
+            continue;
+        }
+        if (type == GEN_QUIET && (promotion || move.is_capture())) {
+            continue;
+        }
 
-                Move move = {pawn_square, dest_square, new_piece_type};
-                allowed_moves.push_back({move, new_game_state});
+        if (promotion) {
+            for (int promotion_flag:{QUEEN_PROMOTION, ROOK_PROMOTION, BISHOP_PROMOTION, KNIGHT_PROMOTION}) {
+                moves.push_back(Move(square, move.dest(), promotion_flag | (move.flags() & CAPTURE)));
             }
         }
+        else {
+            moves.push_back(move);
+        }
     }
-
-    return allowed_moves;
 }
 
-std::vector<PossibleMove> pawn_en_passant_moves(const GameState &game_state, Piece pawn, Square pawn_square) {
-    Coordinate pawn_coord = square_to_coord(pawn_square);
-    int move_direction_rank = (pawn.color == "white" ? 1 : -1);
-
-    std::vector<PossibleMove> allowed_moves;
+void generate_pseudo_legal(Position &position, const MoveGenInfo &info, MoveList &moves, GenType type) {
+    PROFILE_SCOPE(move_generation_millis);
+    uint64_t our_pieces = position.colors[position.side_to_move];
+    if (info.check_mask == 0) { // double check
+        our_pieces = square_bit(info.king);
+    }
 
-    if (pawn_square.rank == (game_state.to_move == "white" ? "5" : "4")) {
-        std::vector<int> potential_file_increments;
-        for (int file_inc:{-1, 1}) {
-            Coordinate adjacent_coord = square_to_coord({
-                std::string(1, pawn_square.file[0] + file_inc),
-                pawn_square.rank
-            });
-            Coordinate dest_coord = square_to_coord({
-                std::string(1, pawn_square.file[0] + file_inc),
-                std::string(1, pawn_square.rank[0] + move_direction_rank)
-            });
-
-            if (valid_coord(adjacent_coord)) {
-                Piece adjacent_piece = game_state.board_state[adjacent_coord.i][adjacent_coord.j];
-
-                if (adjacent_piece.active && adjacent_piece.color != game_state.to_move && adjacent_piece.type == "pawn" && adjacent_piece.last_move_index == game_state.moves && adjacent_piece.moves == 1) { // we can capture this pawn en passant
-                    GameState new_game_state = game_state;
-
-                    new_game_state.moves = game_state.moves + 1;
-                    new_game_state.last_capture_or_pawn_move = game_state.moves + 1;
-
-                    // move pawn
-                    new_game_state.board_state[pawn_coord.i][pawn_coord.j].active = false;
-                    new_game_state.board_state[dest_coord.i][dest_coord.j] = pawn;
-                    new_game_state.board_state[dest_coord.i][dest_coord.j].moves = pawn.moves + 1;
-                    new_game_state.board_state[dest_coord.i][dest_coord.j].last_move_index = game_state.moves + 1;
-
-                    // delete opponent pawn
-                    new_game_state.board_state[adjacent_coord.i][adjacent_coord.j].active = false;
-
-                    new_game_state.previous_states[new_game_state.hash()]++;
-
-                    if (!is_targeted(new_game_state, king_square(new_game_state))) { // we don't put our king in check, so this move is valid
-                        new_game_state.to_move = game_state.to_move == "white" ? "black" : "white";
-                        Move move = {pawn_square, coord_to_square(dest_coord), "pawn"};
-                        allowed_moves.push_back({move, new_game_state});
-                    }
-                }
-            }
+    while (our_pieces) { // go through all our pieces
+        int square = pop_lsb(our_pieces);
+        if (position.board[square] == PAWN) {
+            pawn_moves(position, info, square, moves, type);
+        }
+        else {
+            normal_piece_moves(position, info, square, moves, type);
         }
     }
 
-    return allowed_moves;
+    if (type != GEN_NOISY) {
+        castling_moves(position, info, moves);
+    }
 }
 
-std::vector<PossibleMove> pawn_moves(const GameState &game_state, Piece pawn, Square pawn_square) {
-    std::vector<PossibleMove> allowed_moves;
-
-    for (PossibleMove pawn_move:pawn_non_en_passant_moves(game_state, pawn, pawn_square)) {
-        allowed_moves.push_back(pawn_move);
+bool is_pseudo_legal(Position &position, const MoveGenInfo &info, Move move) {
+    PROFILE_SCOPE(legality_millis);
+    int source = move.source();
+    if (move == NO_MOVE || !(position.colors[position.side_to_move] & square_bit(source))) {
+        return false;
     }
 
-    for (PossibleMove pawn_move:pawn_en_passant_moves(game_state, pawn, pawn_square)) {
-        allowed_moves.push_back(pawn_move);
+    // generate the moves of just that piece and look for it
+    MoveList candidates;
+    if (move.flags() == KING_CASTLE || move.flags() == QUEEN_CASTLE) {
+        castling_moves(position, info, candidates);
+    }
+    else if (position.board[source] == PAWN) {
+        pawn_moves(position, info, source, candidates);
+    }
+    else {
+        normal_piece_moves(position, info, source, candidates);
     }
 
-    return allowed_moves;
+    return std::find(candidates.begin(), candidates.end(), move) != candidates.end();
 }
 
-std::vector<PossibleMove> possible_moves(const GameState &game_state) {
-    std::vector<PossibleMove> allowed_moves;
+void generate_moves(Position &position, MoveList &moves) {
+    MoveGenInfo info = move_gen_info(position);
 
-    for (int i = 0; i <= 7; i++) {
-        for (int j = 0; j <= 7; j++) {
-            Piece piece = game_state.board_state[i][j];
-            Square square = coord_to_square({i, j});
-            if (piece.active && piece.color == game_state.to_move){ // brute force through all our pieces
-                if (piece.type != "pawn") {
-                    for (PossibleMove move:normal_piece_moves(game_state, piece, square)) {
-                        allowed_moves.push_back(move);
-                    }              
-                }
-                if (piece.type == "king" && piece.last_move_index == 0) { // king hasn't moved: check for castling
-                    for (PossibleMove castling_move:castling_moves(game_state, piece, square)) {
-                        allowed_moves.push_back(castling_move);
-                    }                    
-                }
-                if (piece.type == "pawn") {
-                    for (PossibleMove pawn_move:pawn_moves(game_state, piece, square)) {
-                        allowed_moves.push_back(pawn_move);
-                    }
-                }
-            }
+    MoveList pseudo_legal;
+    generate_pseudo_legal(position, info, pseudo_legal);
+
+    for (Move move:pseudo_legal) {
+        if (is_legal(position, info, move)) {
+            moves.push_back(move);
         }
     }
+}
+
+static thread_local std::mt19937 move_order_rng(time(0));
+
+void seed_move_order(uint32_t seed) {
+    move_order_rng.seed(seed);
+}
+
+void possible_moves(Position &position, MoveList &moves) {
+    generate_moves(position, moves);
 
     // randomise moves
-    static std::mt19937 rng(time(0));
-    std::shuffle(allowed_moves.begin(), allowed_moves.end(), rng);
+    std::shuffle(moves.begin(), moves.end(), move_order_rng);
+
+    // score each move by how much advantage it leaves the opponent
+    int scores[MAX_MOVES];
+    for (int i = 0; i < moves.size; i++) {
+        position.make_move(moves[i]);
+        scores[i] = position.eval();
+        position.unmake_move();
+    }
 
     // put the best moves first and randomise equal moves by stable sorting
-    std::stable_sort(allowed_moves.begin(), allowed_moves.end(), [](const PossibleMove a, const PossibleMove b) {
-        return a.game_state.eval() < b.game_state.eval();
-    });
+    for (int i = 1; i < moves.size; i++) {
+        Move move = moves[i];
+        int score = scores[i];
+
+        int j = i;
+        for (; j > 0 && scores[j - 1] > score; j--) {
+            moves[j] = moves[j - 1];
+            scores[j] = scores[j - 1];
+        }
+        moves[j] = move;
+        scores[j] = score;
+    }
+}
 
-    return allowed_moves;
+PossibleMove to_possible_move(const GameState &game_state, Position &position, Move move) {
+    const Piece &piece = game_state.board_state[file_of(move.source())][rank_of(move.source())];
+    std::string new_piece_type = (move.is_promotion() ? piece_type_name(move.promotion()) : piece.type);
+
+    SquareMove square_move = {index_to_square(move.source()), index_to_square(move.dest()), new_piece_type};
+    position.make_move(move);
+    uint64_t new_key = position.key;
+    position.unmake_move();
+
+    return {square_move, game_state.after_move(move, new_key)};
 }
 
-EMSCRIPTEN_BINDINGS(possible_moves_lib) {
-    register_vector<PossibleMove>("PossibleMoveVector");
-    function("possibleMoves", &possible_moves);
+std::vector<PossibleMove> possible_moves(const GameState &game_state) {
+    Position position = game_state.to_position();
+    MoveList moves;
+    generate_moves(position, moves);
+
+    std::vector<PossibleMove> allowed_moves;
+    for (Move move:moves) {
+        allowed_moves.push_back(to_possible_move(game_state, position, move));
+    }
+
+    return allowed_moves;
 }
@@ -3,8 +3,43 @@
 #include <vector>
 #include "structs.h"
 
-std::vector<PossibleMove> normal_piece_moves(const GameState &game_state, Piece piece, Square square);
-std::vector<PossibleMove> castling_moves(const GameState &game_state, Piece king, Square king_pos_square);
-std::vector<PossibleMove> pawn_moves(const GameState &game_state, Piece pawn, Square pawn_square);
+// computed once per position, so that most generated moves need no legality check
+struct MoveGenInfo {
+    int king = NO_SQUARE;
+    uint64_t checkers = 0;
+    uint64_t check_mask = ~0ULL; // squares a non-king move has to land on to deal with a check: everywhere when not in check, nowhere in double check
+    uint64_t pinned = 0; // our pieces that can't leave the line between our king and an enemy slider
+};
 
+MoveGenInfo move_gen_info(const Position &position);
+
+// which moves to generate, so a move picker can generate captures and quiet moves separately
+enum GenType {
+    GEN_NOISY, // captures, en passant and promotions
+    GEN_QUIET, // everything else, including castling
+    GEN_ALL
+};
+
+// the generators produce pseudo-legal moves that already respect check_mask
+// only king moves, en passant and moves of pinned pieces can still be illegal, and is_legal only does real work for those
+void normal_piece_moves(Position &position, const MoveGenInfo &info, int square, MoveList &moves, GenType type = GEN_ALL);
+void castling_moves(Position &position, const MoveGenInfo &info, MoveList &moves);
+void pawn_moves(Position &position, const MoveGenInfo &info, int square, MoveList &moves, GenType type = GEN_ALL);
+void generate_pseudo_legal(Position &position, const MoveGenInfo &info, MoveList &moves, GenType type = GEN_ALL);
+
+bool is_legal(Position &position, const MoveGenInfo &info, Move move);
+
+// could the move be generated in this position? for moves that come from elsewhere, like the transposition table
+bool is_pseudo_legal(Position &position, const MoveGenInfo &info, Move move);
+
+// all legal moves, in board order
+void generate_moves(Position &position, MoveList &moves);
+
+// all legal moves, shuffled and then ordered best-looking first; for the root of the search, where the variety is welcome
+void possible_moves(Position &position, MoveList &moves);
+
+// restarts the shuffle of the calling thread from a fixed seed, so its searches can be repeated move for move, as in benchmarks
+void seed_move_order(uint32_t seed);
+
+PossibleMove to_possible_move(const GameState &game_state, Position &position, Move move);
 std::vector<PossibleMove> possible_moves(const GameState &game_state);
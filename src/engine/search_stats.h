@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+const int CUTOFF_SLOTS = 8; // cutoffs by the first few move indices, the last slot counting every later move
+
+// what a search did, reported after every iteration to tune it; doubles so they cross the Embind boundary as plain numbers
+// nodes and nps include the helper threads, the rest is counted by the main thread only, as the helpers search the same tree
+struct SearchStats {
+    int depth = 0;
+    int selective_depth = 0; // deepest ply reached, quiescence included
+    double nodes = 0;
+    double quiescence_nodes = 0;
+    double nps = 0;
+    double branching_factor = 0; // nodes of the last iteration over those of the one before
+
+    double beta_cutoffs = 0; // in the main search
+    std::vector<double> cutoffs_by_move = std::vector<double>(CUTOFF_SLOTS, 0.0); // by the index of the move that caused them
+
+    double tt_probes = 0;
+    double tt_hits = 0;
+
+    double millis = 0;
+    // only measured in builds with SEARCH_PROFILE defined, as reading the clock this often slows the search down
+    double move_generation_millis = 0;
+    double evaluation_millis = 0;
+    double legality_millis = 0;
+};
+
+// time spent in each part of the search, added up by the functions themselves for the thread calling them
+struct SearchProfile {
+    double move_generation_millis = 0;
+    double evaluation_millis = 0;
+    double legality_millis = 0;
+};
+
+extern thread_local SearchProfile search_profile;
+
+#ifdef SEARCH_PROFILE
+// adds the time until the end of the scope to one of the search_profile counters
+struct ProfileTimer {
+    double &total;
+    std::chrono::steady_clock::time_point start;
+
+    explicit ProfileTimer(double &total) : total(total), start(std::chrono::steady_clock::now()) {}
+    ~ProfileTimer() {
+        total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+#define PROFILE_SCOPE(counter) ProfileTimer profile_timer(search_profile.counter)
+#else
+#define PROFILE_SCOPE(counter)
+#endif
@@ -0,0 +1,68 @@
+#include <algorithm>
+
+#include "see.h"
+#include "attacks.h"
+#include "utils.h"
+#include "game_helper_funcs.h"
+
+int see(const Position &position, Move move) {
+    int source = move.source();
+    int dest = move.dest();
+    int side = position.side_to_move;
+
+    uint64_t occupied = position.occupied() ^ square_bit(source);
+    int captured = position.board[dest];
+    if (move.flags() == EN_PASSANT) {
+        captured = PAWN;
+        occupied ^= square_bit(dest + (side == WHITE ? -8 : 8));
+    }
+
+    int attacker = (move.is_promotion() ? move.promotion() : position.board[source]);
+
+    int gain[32];
+    int depth = 0;
+    gain[0] = (captured == NO_PIECE_TYPE ? 0 : PIECE_VALUES[captured]);
+    if (move.is_promotion()) {
+        gain[0] += PIECE_VALUES[attacker] - PIECE_VALUES[PAWN];
+    }
+
+    uint64_t diagonal_sliders = position.pieces[WHITE][BISHOP] | position.pieces[BLACK][BISHOP] | position.pieces[WHITE][QUEEN] | position.pieces[BLACK][QUEEN];
+    uint64_t straight_sliders = position.pieces[WHITE][ROOK] | position.pieces[BLACK][ROOK] | position.pieces[WHITE][QUEEN] | position.pieces[BLACK][QUEEN];
+    uint64_t attackers = (attackers_to(position, dest, WHITE, occupied) | attackers_to(position, dest, BLACK, occupied)) & occupied;
+
+    while (true) {
+        side ^= 1;
+        uint64_t side_attackers = attackers & position.colors[side];
+        if (!side_attackers) {
+            break;
+        }
+
+        // recapture with the least valuable piece
+        int piece_type = PAWN;
+        while (!(side_attackers & position.pieces[side][piece_type])) {
+            piece_type++;
+        }
+        if (piece_type == KING && (attackers & position.colors[side ^ 1])) { // the king can't capture onto a defended square
+            break;
+        }
+
+        depth++;
+        gain[depth] = PIECE_VALUES[attacker] - gain[depth - 1]; // what this side has gained if the exchange stops after its recapture
+        if (depth == 31) {
+            break;
+        }
+
+        // moving the recapturing piece can uncover a slider behind it
+        occupied ^= square_bit(lsb(side_attackers & position.pieces[side][piece_type]));
+        attackers |= (bishop_attacks(dest, occupied) & diagonal_sliders) | (rook_attacks(dest, occupied) & straight_sliders);
+        attackers &= occupied;
+        attacker = piece_type;
+    }
+
+    // each side can choose not to recapture, working back from the end of the sequence
+    while (depth > 0) {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+        depth--;
+    }
+    return gain[0];
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "structs.h"
+
+// static exchange evaluation: the material the side to move wins (or loses, if negative) by making the capture
+// and then both sides recapturing on the destination square with their least valuable piece for as long as it pays
+int see(const Position &position, Move move);
@@ -1,86 +1,615 @@
-#include <emscripten/bind.h>
-
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include "strategies.h"
 #include "possible_moves.h"
 #include "game_helper_funcs.h"
-
-using namespace emscripten;
+#include "transposition_table.h"
+#include "move_picker.h"
+#include "see.h"
+#include "opening_book.h"
+#include "endgame_tables.h"
+#include "utils.h"
 
 const int DEPTH = 3;
-const double MOBILITY_FACTOR = 0.02;
-const double CASTLING_FACTOR = 0.75;
-const double INF = 1e9;
+const int INF = 1000000;
+const int TIME_CHECK_INTERVAL = 1024; // nodes between looking at the clock
+const int DELTA_MARGIN = 200; // positional swing a capture might bring on top of the material it wins
+const int NULL_MOVE_MIN_DEPTH = 3;
+const int LMR_MIN_DEPTH = 3;
+const int LMR_MIN_MOVES = 3; // the first few moves are searched at full depth, as move ordering expects one of them to be best
+
+bool (*stop_requested_hook)() = nullptr;
+void (*iteration_hook)(const SearchInfo &info) = nullptr;
+bool (*ponder_hit_hook)() = nullptr;
+
+int search_threads = 1;
+
+thread_local SearchProfile search_profile;
+
+struct SearchContext {
+    int thread_id = 0; // thread 0 is the main thread, which plays its move; the others only fill the transposition table
+    std::atomic<bool> *shared_stop = nullptr; // set by the main thread to stop the helpers
+    std::atomic<uint64_t> *helper_nodes = nullptr; // nodes searched by the helpers, added every few nodes
+    TranspositionTable *table = &transposition_table;
+
+    bool timed = false;
+    bool pondering = false; // the time budget starts once the ponder hit hook says so
+    int millis = 0;
+    std::chrono::steady_clock::time_point clock_start;
+    std::chrono::steady_clock::time_point deadline;
+    bool stopped = false;
+    uint64_t nodes = 0;
+    uint64_t quiescence_nodes = 0;
+    uint64_t cutoffs_by_move[CUTOFF_SLOTS] = {};
+    int selective_depth = 0;
+
+    // move ordering state, kept across iterations: quiet moves that caused a cutoff at each ply,
+    // and how often each quiet move (by side, source and destination) has done so
+    // both point into a heap allocated SearchState, as they are too big for the Wasm build's small stack
+    Move (*killers)[2] = nullptr;
+    int (*history)[64][64] = nullptr;
+};
+
+void start_clock(SearchContext &context) {
+    context.pondering = false;
+    context.clock_start = std::chrono::steady_clock::now();
+    context.deadline = context.clock_start + std::chrono::milliseconds(context.millis);
+}
 
-// evaluates how much advantage the player to move has
-double eval(const GameState& game_state, const int depth, double alpha = -INF) {
-    if (is_checkmate(game_state)) {
-        return -INF;
+// counts the node, and checks whether we have run out of time or have been asked to stop
+// reading the clock and calling the hook are slow, so only do it every few nodes
+// only the main thread looks at the clock and the hook, since the hook may only be called from the thread that started the search
+bool should_stop(SearchContext &context) {
+    context.nodes++;
+    if (context.nodes % TIME_CHECK_INTERVAL == 0) {
+        if (context.thread_id == 0) {
+            if (context.pondering && ponder_hit_hook && ponder_hit_hook()) {
+                start_clock(context);
+            }
+            if (context.timed && !context.pondering && std::chrono::steady_clock::now() >= context.deadline) {
+                context.stopped = true;
+            }
+            if (stop_requested_hook && stop_requested_hook()) {
+                context.stopped = true;
+            }
+            if (context.stopped) {
+                context.shared_stop->store(true, std::memory_order_relaxed);
+            }
+        }
+        else {
+            context.helper_nodes->fetch_add(TIME_CHECK_INTERVAL, std::memory_order_relaxed);
+            if (context.shared_stop->load(std::memory_order_relaxed)) {
+                context.stopped = true;
+            }
+        }
     }
-    if (is_draw(game_state)) {
-        return 0.0;
+    return context.stopped;
+}
+
+// mate scores are stored relative to the node rather than the root, so they stay valid in transposed positions
+int score_to_tt(int score, int ply) {
+    if (score >= MATE_BOUND) return score + ply;
+    if (score <= -MATE_BOUND) return score - ply;
+    return score;
+}
+
+int score_from_tt(int score, int ply) {
+    if (score >= MATE_BOUND) return score - ply;
+    if (score <= -MATE_BOUND) return score + ply;
+    return score;
+}
+
+// search this move first
+void move_to_front(MoveList &moves, Move move) {
+    Move *found = std::find(moves.begin(), moves.end(), move);
+    if (found != moves.end()) {
+        std::rotate(moves.begin(), found, found + 1);
     }
+}
 
-    if (depth <= 0) { // base case: simply count material advantage on the board
-        return game_state.eval();
+// a quiet move caused a cutoff: make it a killer at this ply, and reward it over the quiet moves tried before it
+void update_quiet_stats(SearchContext &context, int side, int ply, int depth, Move move, const Move *quiets_tried, int quiet_count) {
+    Move *killers = context.killers[ply];
+    if (killers[0] != move) {
+        killers[1] = killers[0];
+        killers[0] = move;
     }
-    
-    std::vector<PossibleMove> next_moves = possible_moves(game_state);
 
-    GameState opp_game_state = game_state;
-    opp_game_state.to_move = (game_state.to_move == "white" ? "black" : "white");
+    int bonus = depth * depth;
+    update_history(context.history[side][move.source()][move.dest()], bonus);
+    for (int i = 0; i < quiet_count; i++) {
+        update_history(context.history[side][quiets_tried[i].source()][quiets_tried[i].dest()], -bonus);
+    }
+}
+
+// searches captures and promotions until the position is quiet, so leaves aren't scored in the middle of an exchange
+// the player to move may stand pat on the material count instead of capturing, unless they are in check
+int quiescence(Position &position, SearchContext &context, int alpha, int beta, const int ply) {
+    if (should_stop(context)) {
+        return 0;
+    }
+    context.quiescence_nodes++;
+    context.selective_depth = std::max(context.selective_depth, ply);
+
+    int us = position.side_to_move;
+    MoveGenInfo info = move_gen_info(position);
+    bool in_check = info.checkers != 0;
+    int stand_pat = position.eval();
+    if (ply >= MAX_PLY) {
+        return stand_pat;
+    }
+
+    int best_score = -INF;
+    if (!in_check) {
+        if (stand_pat >= beta) {
+            return stand_pat;
+        }
+        best_score = stand_pat;
+        alpha = std::max(alpha, stand_pat);
+    }
 
-    int player_moves = (int)next_moves.size();
-    int opponent_moves = (int)possible_moves(opp_game_state).size();
+    // in check every evasion has to be searched, or a mate could be missed
+    MovePicker picker = (in_check ? MovePicker(position, info, NO_MOVE, context.killers[ply], context.history[us]) : MovePicker(position, info));
+    for (Move move = picker.next(); move != NO_MOVE; move = picker.next()) {
+        if (!in_check) {
+            int victim = (move.flags() == EN_PASSANT ? (int)PAWN : (int)position.board[move.dest()]);
+            int material_gain = (move.is_capture() ? PIECE_VALUES[victim] : 0) + (move.is_promotion() ? PIECE_VALUES[move.promotion()] - PIECE_VALUES[PAWN] : 0);
+            if (stand_pat + material_gain + DELTA_MARGIN <= alpha) { // delta pruning: even winning the piece for free wouldn't reach alpha
+                continue;
+            }
+            if (move.is_capture() && see(position, move) < 0) { // the exchange loses material
+                continue;
+            }
+        }
 
-    double additional_advantage = MOBILITY_FACTOR * (player_moves - opponent_moves) + CASTLING_FACTOR * (game_state.to_move == "white" ? 1.0 : -1.0) * (game_state.castling_advantage_white - game_state.castling_advantage_black);
+        position.make_move(move);
+        int score = -quiescence(position, context, -beta, -alpha, ply + 1);
+        position.unmake_move();
 
-    // search through our moves
-    double base_advantage = -INF;
-    for (PossibleMove move:next_moves) {
-        double beta = std::max(std::min(base_advantage + additional_advantage, INF), -INF); // advantage that we can force
-        if (beta > -alpha) { // this move is worse for the opponent than their best move so far
-            return INF;
+        if (context.stopped) {
+            return 0;
         }
 
-        base_advantage = std::max(base_advantage, -eval(move.game_state, depth - 1, beta));
+        best_score = std::max(best_score, score);
+        alpha = std::max(alpha, score);
+        if (alpha >= beta) {
+            break;
+        }
     }
 
-    return std::max(std::min(base_advantage + additional_advantage, INF), -INF);
+    if (best_score == -INF) { // in check with no way out
+        return -MATE_SCORE + ply;
+    }
+    return best_score;
 }
 
-PossibleMove negamax_move(const GameState &game_state, const int depth) {
-    std::vector<PossibleMove> next_moves = possible_moves(game_state);
+// late move reduction for the nth move searched at a depth: later moves and deeper searches are reduced more
+int lmr_reduction(int depth, int move_number) {
+    static const auto table = []() {
+        std::vector<std::vector<int>> reductions(MAX_PLY, std::vector<int>(MAX_MOVES, 0));
+        for (int d = 1; d < MAX_PLY; d++) {
+            for (int n = 1; n < MAX_MOVES; n++) {
+                reductions[d][n] = (int)(0.75 + std::log(d) * std::log(n) / 2.25);
+            }
+        }
+        return reductions;
+    }();
+    return table[std::min(depth, MAX_PLY - 1)][std::min(move_number, MAX_MOVES - 1)];
+}
+
+// without pieces other than pawns, passing is often the best move (zugzwang), so the null move observation doesn't hold
+bool has_non_pawn_material(const Position &position, int color) {
+    return position.pieces[color][KNIGHT] | position.pieces[color][BISHOP] | position.pieces[color][ROOK] | position.pieces[color][QUEEN];
+}
+
+// evaluates how much advantage the player to move has, searching only as far as needed to tell if it lies within (alpha, beta)
+// principal variation search: the first move gets the full window, and the rest a null window to prove they are no better,
+// re-searched in full only if one is; the score is fail-soft, so a bound outside the window is as tight as the search found it
+// the position is searched in place with make/unmake, and is restored before returning
+// once the search is stopped the returned score is meaningless and must be discarded
+int eval(Position &position, SearchContext &context, const int depth, int alpha, int beta, const int ply, const bool null_move_allowed = true) {
+    if (should_stop(context)) {
+        return 0;
+    }
+    context.selective_depth = std::max(context.selective_depth, ply);
+
+    // a repetition is a draw, and checked before the TT, whose scores don't know how the position was reached
+    if (position.is_repetition(ply)) {
+        return 0;
+    }
+
+    // with so few pieces left the result is known exactly
+    EndgameResult endgame_result;
+    if (probe_endgame_tables(position, endgame_result)) {
+        return endgame_table_score(endgame_result, ply);
+    }
+
+    bool pv_node = (beta - alpha > 1);
+    int original_alpha = alpha;
 
-    GameState opp_game_state = game_state;
-    opp_game_state.to_move = (game_state.to_move == "white" ? "black" : "white");
+    TTEntry entry;
+    Move hash_move = NO_MOVE;
+    if (context.table->probe(position.key, entry)) {
+        hash_move = entry.move;
 
-    int player_moves = (int)next_moves.size();
-    int opponent_moves = (int)possible_moves(opp_game_state).size();
+        // cutting off on a PV node would cut the principal variation short
+        int tt_score = score_from_tt(entry.score, ply);
+        if (!pv_node && entry.depth >= depth && (
+            entry.bound == BOUND_EXACT ||
+            (entry.bound == BOUND_LOWER && tt_score >= beta) ||
+            (entry.bound == BOUND_UPPER && tt_score <= alpha)
+        )) {
+            return tt_score;
+        }
+    }
 
-    double additional_advantage = MOBILITY_FACTOR * (player_moves - opponent_moves) + CASTLING_FACTOR * (game_state.to_move == "white" ? 1.0 : -1.0) * (game_state.castling_advantage_white - game_state.castling_advantage_black);
+    if (fifty_move_rule(position) || insufficient_material(position)) {
+        return 0;
+    }
+
+    if (depth <= 0 || ply >= MAX_PLY - 1) { // base case: settle the exchanges on the board, then evaluate
+        int score = quiescence(position, context, alpha, beta, ply);
+        if (context.stopped) {
+            return 0;
+        }
+
+        int bound = (score <= original_alpha ? BOUND_UPPER : (score >= beta ? BOUND_LOWER : BOUND_EXACT));
+        context.table->store(position.key, 0, score_to_tt(score, ply), bound, NO_MOVE);
+        return score;
+    }
+
+    // the picker reuses these, so finding out whether we are in check costs nothing extra
+    int us = position.side_to_move;
+    MoveGenInfo info = move_gen_info(position);
+    bool in_check = info.checkers != 0;
+
+    // null move pruning: if passing still leaves us at or above beta after a reduced search, a real move almost certainly would too
+    // skipped in check (passing would be illegal), right after another null move, and without pieces (zugzwang)
+    if (!pv_node && !in_check && null_move_allowed && depth >= NULL_MOVE_MIN_DEPTH && has_non_pawn_material(position, us) && position.eval() >= beta) {
+        int reduction = 2 + depth / 4; // deeper searches can afford to look less far past the pass
+
+        position.make_null_move();
+        int score = -eval(position, context, depth - 1 - reduction, -beta, -beta + 1, ply + 1, false);
+        position.unmake_null_move();
+
+        if (context.stopped) {
+            return 0;
+        }
+        if (score >= beta) {
+            return (score >= MATE_BOUND ? beta : score); // a mate found after passing isn't a real mate
+        }
+    }
+
+    MovePicker picker(position, info, hash_move, context.killers[ply], context.history[us]);
+
+    int best_score = -INF;
+    Move best_move = NO_MOVE;
+    Move quiets_tried[MAX_MOVES];
+    int quiet_count = 0;
+    int move_count = 0;
+    for (Move move = picker.next(); move != NO_MOVE; move = picker.next()) {
+        move_count++;
+
+        position.make_move(move);
+        bool gives_check = is_targeted(position, position.king_square(position.side_to_move));
+
+        int score;
+        if (move_count == 1) {
+            score = -eval(position, context, depth - 1, -beta, -alpha, ply + 1);
+        }
+        else {
+            // late move reductions: quiet moves this far down the ordering rarely turn out best, so search them less deeply
+            // unless they are tactical, or have a good history
+            int reduction = 0;
+            if (depth >= LMR_MIN_DEPTH && move_count > LMR_MIN_MOVES && !move.is_noisy() && !in_check && !gives_check) {
+                reduction = lmr_reduction(depth, move_count);
+                reduction -= (context.history[us][move.source()][move.dest()] > 0);
+                reduction += !pv_node;
+                reduction = std::clamp(reduction, 0, depth - 2);
+            }
+
+            score = -eval(position, context, depth - 1 - reduction, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && reduction > 0) { // the reduced search looked promising, so check at full depth
+                score = -eval(position, context, depth - 1, -alpha - 1, -alpha, ply + 1);
+            }
+            if (score > alpha && score < beta) { // better than the PV so far: find its exact score
+                score = -eval(position, context, depth - 1, -beta, -alpha, ply + 1);
+            }
+        }
+
+        position.unmake_move();
+
+        if (context.stopped) {
+            return 0;
+        }
+
+        if (score > best_score) {
+            best_score = score;
+            best_move = move;
+        }
+
+        alpha = std::max(alpha, best_score);
+        if (alpha >= beta) { // this move is worse for the opponent than their best move so far
+            context.cutoffs_by_move[std::min(move_count, CUTOFF_SLOTS) - 1]++;
+            if (!move.is_noisy()) {
+                update_quiet_stats(context, us, ply, depth, move, quiets_tried, quiet_count);
+            }
+            break;
+        }
+
+        if (!move.is_noisy()) {
+            quiets_tried[quiet_count++] = move;
+        }
+    }
 
+    if (best_move == NO_MOVE) { // no legal moves: checkmate or stalemate
+        return (in_check ? -MATE_SCORE + ply : 0);
+    }
+
+    int bound = (best_score <= original_alpha ? BOUND_UPPER : (best_score >= beta ? BOUND_LOWER : BOUND_EXACT));
+    context.table->store(position.key, depth, score_to_tt(best_score, ply), bound, best_move);
+
+    return best_score;
+}
+
+// searches every root move to the given depth and returns the best one, along with its score
+Move negamax_move(Position &position, MoveList &root_moves, const int depth, SearchContext &context, int &best_score) {
     // play the move that maximises our advantage
-    double base_advantage = - 2 * INF; // must always be overridden
-    PossibleMove best_move;
-    for (PossibleMove move:next_moves) {
-        double alpha = std::max(std::min(base_advantage + additional_advantage, INF), -INF);
-        double eval_child = -eval(move.game_state, depth - 1, alpha);
-
-        if (eval_child > base_advantage) {
-            base_advantage = eval_child;
+    best_score = -INF;
+    Move best_move = NO_MOVE;
+    for (Move move:root_moves) {
+        position.make_move(move);
+        int eval_child;
+        if (best_move == NO_MOVE) {
+            eval_child = -eval(position, context, depth - 1, -INF, INF, 1);
+        }
+        else { // as in eval(), prove the later moves worse with a null window first
+            eval_child = -eval(position, context, depth - 1, -best_score - 1, -best_score, 1);
+            if (eval_child > best_score && !context.stopped) {
+                eval_child = -eval(position, context, depth - 1, -INF, -best_score, 1);
+            }
+        }
+        position.unmake_move();
+
+        if (context.stopped) {
+            return NO_MOVE;
+        }
+
+        if (best_move == NO_MOVE || eval_child > best_score) {
+            best_score = eval_child;
             best_move = move;
         }
     }
 
+    context.table->store(position.key, depth, score_to_tt(best_score, 0), BOUND_EXACT, best_move);
+
     return best_move;
 }
 
+// follows the best moves stored in the transposition table from the position, after the given first move
+std::vector<Move> principal_variation(Position &position, TranspositionTable &table, Move first_move, int max_length) {
+    std::vector<Move> pv = {first_move};
+    position.make_move(first_move);
+
+    TTEntry entry;
+    while ((int)pv.size() < max_length && table.probe(position.key, entry) && entry.move != NO_MOVE) {
+        MoveGenInfo info = move_gen_info(position);
+        if (!is_pseudo_legal(position, info, entry.move) || !is_legal(position, info, entry.move)) { // a different position in the same slot
+            break;
+        }
+
+        pv.push_back(entry.move);
+        position.make_move(entry.move);
+    }
+
+    for (size_t i = 0; i < pv.size(); i++) {
+        position.unmake_move();
+    }
+    return pv;
+}
+
+// what the search has done so far, once it has completed an iteration that searched iteration_nodes nodes on the main thread
+SearchStats collect_stats(const SearchContext &context, const SearchInfo &info, uint64_t iteration_nodes, uint64_t previous_iteration_nodes) {
+    SearchStats stats;
+    stats.depth = info.depth;
+    stats.selective_depth = context.selective_depth;
+    stats.nodes = (double)info.nodes;
+    stats.quiescence_nodes = (double)context.quiescence_nodes;
+    stats.nps = stats.nodes * 1000 / std::max(info.millis, 1);
+    stats.branching_factor = (previous_iteration_nodes ? (double)iteration_nodes / previous_iteration_nodes : 0);
+
+    for (int i = 0; i < CUTOFF_SLOTS; i++) {
+        stats.cutoffs_by_move[i] = (double)context.cutoffs_by_move[i];
+        stats.beta_cutoffs += stats.cutoffs_by_move[i];
+    }
+
+    TTStats tt_stats = context.table->current_stats();
+    stats.tt_probes = tt_stats.probes;
+    stats.tt_hits = tt_stats.hits;
+
+    stats.millis = info.millis;
+    stats.move_generation_millis = search_profile.move_generation_millis;
+    stats.evaluation_millis = search_profile.evaluation_millis;
+    stats.legality_millis = search_profile.legality_millis;
+    return stats;
+}
+
+// searches to depth first_depth, first_depth + 1, ... until max_depth is reached, the time budget runs out or the search is stopped,
+// and returns the best move of the last completed iteration
+Move deepen(Position &position, MoveList &root_moves, const int first_depth, const int max_depth, const int millis, SearchContext &context) {
+    auto start_time = std::chrono::steady_clock::now();
+    context.millis = millis;
+    if (!context.pondering) {
+        start_clock(context);
+    }
+
+    Move best_move = root_moves[0];
+    uint64_t previous_iteration_nodes = 0;
+    for (int depth = first_depth; depth <= max_depth; depth++) {
+        context.timed = (millis > 0 && depth > 1);
+
+        int score;
+        uint64_t nodes_before = context.nodes;
+        Move move = negamax_move(position, root_moves, depth, context, score);
+        if (context.stopped) { // an unfinished iteration can't be trusted
+            break;
+        }
+        uint64_t iteration_nodes = context.nodes - nodes_before;
+
+        // search this iteration's best move first in the next one
+        best_move = move;
+        move_to_front(root_moves, best_move);
+
+        if (context.thread_id != 0) {
+            continue;
+        }
+
+        if (iteration_hook) {
+            SearchInfo info;
+            info.depth = depth;
+            info.score = score;
+            info.nodes = context.nodes + context.helper_nodes->load(std::memory_order_relaxed);
+            info.millis = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+            info.pv = principal_variation(position, *context.table, best_move, depth);
+            info.stats = collect_stats(context, info, iteration_nodes, previous_iteration_nodes);
+            iteration_hook(info);
+        }
+        previous_iteration_nodes = iteration_nodes;
+
+        if (std::abs(score) >= MATE_BOUND) { // searching deeper won't change a forced mate
+            break;
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - context.clock_start;
+        if (millis > 0 && !context.pondering && elapsed * 2 >= std::chrono::milliseconds(millis)) { // the next iteration would most likely not finish in time
+            break;
+        }
+    }
+
+    return best_move;
+}
+
+// lazy SMP: helper threads search the same root on their own copy of the position, sharing only the transposition table
+// starting at different depths with the root moves in a different order sends them down different lines,
+// and the main thread finds their results in the table
+void helper_search(Position position, MoveList root_moves, const int max_depth, const int thread_id, TranspositionTable *table, std::atomic<bool> *shared_stop, std::atomic<uint64_t> *helper_nodes) {
+    std::unique_ptr<SearchState> statistics = std::make_unique<SearchState>();
+    SearchContext context;
+    context.thread_id = thread_id;
+    context.shared_stop = shared_stop;
+    context.helper_nodes = helper_nodes;
+    context.table = table;
+    context.killers = statistics->killers;
+    context.history = statistics->history;
+
+    std::rotate(root_moves.begin(), root_moves.begin() + thread_id % root_moves.size, root_moves.end());
+    deepen(position, root_moves, 1 + thread_id % 2, max_depth, 0, context);
+}
+
+// plays the main thread's move; the time limit doesn't apply to depth 1, so there is almost always a searched move to play
+Move iterative_deepening(Position &position, const int max_depth, const int millis, SearchState *state, const bool ponder) {
+    TranspositionTable *table = (state ? state->table : &transposition_table);
+    table->new_search();
+
+    // play from the endgame tables at the root once they're built and cover the position
+    SearchInfo table_info;
+    Move table_move = endgame_table_move(position, table_info.score);
+    if (table_move != NO_MOVE) {
+        table_info.depth = 1;
+        table_info.pv = {table_move};
+        if (iteration_hook) {
+            iteration_hook(table_info);
+        }
+        return table_move;
+    }
+
+    MoveList root_moves;
+    possible_moves(position, root_moves);
+    if (root_moves.empty()) {
+        return NO_MOVE;
+    }
+
+    std::atomic<bool> shared_stop(false);
+    std::atomic<uint64_t> helper_nodes(0);
+    std::vector<std::thread> helpers;
+    int threads = (state ? state->threads : search_threads);
+    for (int thread_id = 1; thread_id < threads; thread_id++) {
+        helpers.emplace_back(helper_search, position, root_moves, max_depth, thread_id, table, &shared_stop, &helper_nodes);
+    }
+
+    // the main thread works on the statistics of the last search in place, leaving its own for the next one,
+    // or on fresh ones without a state
+    std::unique_ptr<SearchState> statistics = (state ? nullptr : std::make_unique<SearchState>());
+    SearchState &ordering = (state ? *state : *statistics);
+    if (state) {
+        state->new_search(position.moves);
+    }
+
+    SearchContext context;
+    context.shared_stop = &shared_stop;
+    context.helper_nodes = &helper_nodes;
+    context.table = table;
+    context.killers = ordering.killers;
+    context.history = ordering.history;
+    search_profile = SearchProfile();
+    context.pondering = ponder;
+    Move best_move = deepen(position, root_moves, 1, max_depth, millis, context);
+
+    shared_stop.store(true, std::memory_order_relaxed);
+    for (std::thread &helper:helpers) {
+        helper.join();
+    }
+
+    return best_move;
+}
+
+void SearchState::clear() {
+    std::fill(&killers[0][0], &killers[0][0] + MAX_PLY * 2, NO_MOVE);
+    std::fill(&history[0][0][0], &history[0][0][0] + 2 * 64 * 64, 0);
+    last_search_moves = -1;
+}
+
+void SearchState::new_search(int moves) {
+    int played = moves - last_search_moves;
+    if (last_search_moves < 0 || played < 0 || played >= MAX_PLY) { // a different game, or moves were taken back
+        std::fill(&killers[0][0], &killers[0][0] + MAX_PLY * 2, NO_MOVE);
+    }
+    else {
+        Move *first = &killers[0][0];
+        std::copy(first + played * 2, first + MAX_PLY * 2, first);
+        std::fill(first + (MAX_PLY - played) * 2, first + MAX_PLY * 2, NO_MOVE);
+    }
+
+    for (int side = 0; side < 2; side++) {
+        for (int source = 0; source < 64; source++) {
+            for (int dest = 0; dest < 64; dest++) {
+                history[side][source][dest] /= 2;
+            }
+        }
+    }
+    last_search_moves = moves;
+}
+
 PossibleMove computer_move(const GameState &game_state) {
-    return negamax_move(game_state, DEPTH);
+    Position position = game_state.to_position();
+    Move book_move = opening_book.probe(position);
+    return to_possible_move(game_state, position, book_move != NO_MOVE ? book_move : iterative_deepening(position, DEPTH, 0));
+}
+
+PossibleMove computer_move_timed(const GameState &game_state, int millis) {
+    Position position = game_state.to_position();
+    Move book_move = opening_book.probe(position);
+    return to_possible_move(game_state, position, book_move != NO_MOVE ? book_move : iterative_deepening(position, MAX_DEPTH, std::max(millis, 1)));
 }
 
-EMSCRIPTEN_BINDINGS(strategies) {
-    function("computerMove", &computer_move);
+int set_threads(int threads) {
+    search_threads = std::clamp(threads, 1, MAX_SEARCH_THREADS);
+    return search_threads;
 }
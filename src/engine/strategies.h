@@ -1,5 +1,75 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include "structs.h"
+#include "transposition_table.h"
+#include "search_stats.h"
+
+// helper threads need std::thread, which a WebAssembly build only has when compiled with -pthread
+#ifndef MAX_SEARCH_THREADS
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define MAX_SEARCH_THREADS 1
+#else
+#define MAX_SEARCH_THREADS 64
+#endif
+#endif
+
+const int MAX_DEPTH = 64;
+const int MAX_PLY = 128;
+const int MATE_SCORE = 100000; // minus the number of plies to the mate
+const int MATE_BOUND = MATE_SCORE - 1000; // scores beyond this are forced mates
+
+// what the search knows after a completed iteration
+struct SearchInfo {
+    int depth = 0;
+    int score = 0; // for the player to move, in centipawns
+    uint64_t nodes = 0; // over all threads
+    int millis = 0; // since the search started
+    std::vector<Move> pv; // principal variation, starting with the best move
+    SearchStats stats;
+};
+
+// optional hooks for whoever embeds the engine: the first is polled every few thousand nodes and stops the search when it returns true,
+// the second is called after every completed iteration, and the third is polled like the first while pondering, and starts the clock
+// when it returns true because the opponent played the move that was pondered on
+extern bool (*stop_requested_hook)();
+extern void (*iteration_hook)(const SearchInfo &info);
+extern bool (*ponder_hit_hook)();
+
+// what one search leaves for the next in the same game: the transposition table it fills, how many threads search,
+// and the move ordering statistics, which would otherwise start empty every move
+struct SearchState {
+    TranspositionTable *table = &transposition_table;
+    int threads = 1;
 
+    Move killers[MAX_PLY][2];
+    int history[2][64][64] = {};
+    int last_search_moves = -1; // position.moves when the last search started
+
+    // forget the statistics, for a new game
+    void clear();
+    // get the statistics ready for a search from a position with the given number of moves played: the killers move down
+    // by the plies played since the last search, so they stay with the positions they were found in, and history is halved
+    void new_search(int moves);
+};
+
+// searches the position and returns the best move, or NO_MOVE if there are no legal moves
+// stops at max_depth, or once the time budget (in milliseconds) is nearly spent; a millis of 0 means no time limit
+// without a state to continue from, it uses the global transposition table and search_threads threads, and starts with empty statistics
+// a ponder search is of the position after the opponent's expected reply, made while they think: its time budget only starts
+// on a ponder hit, and until then it runs until stopped, or until it reaches max_depth or a mate
+Move iterative_deepening(Position &position, int max_depth, int millis, SearchState *state = nullptr, bool ponder = false);
+
+// the best line stored in the transposition table, from the given first move in the position
+std::vector<Move> principal_variation(Position &position, TranspositionTable &table, Move first_move, int max_length);
+
+// both play a move from the opening book instead of searching when it has one
 PossibleMove computer_move(const GameState &game_state);
+
+// deepens the search until the time budget (in milliseconds) runs out
+PossibleMove computer_move_timed(const GameState &game_state, int millis);
+
+// number of threads searching each move, clamped to what the build supports; returns the number actually used
+int set_threads(int threads);
@@ -1,109 +1,412 @@
-#include <emscripten/bind.h>
+#include <cstdlib>
+#include <algorithm>
 
 #include "structs.h"
+#include "attacks.h"
+#include "utils.h"
+#include "zobrist.h"
+#include "piece_square_tables.h"
+#include "search_stats.h"
 
-using namespace emscripten;
+const std::string PIECE_TYPE_NAMES[6] = {"pawn", "knight", "bishop", "rook", "queen", "king"};
 
-double Piece::value() const {
-    if (type == "pawn") return 1.0;
-    if (type == "knight") return 3.0;
-    if (type == "bishop") return 3.0;
-    if (type == "rook") return 5.0;
-    if (type == "queen") return 9.0;
-    if (type == "king") return 100.0;
-    return 0.0;
+std::string piece_type_name(int piece_type) {
+    return PIECE_TYPE_NAMES[piece_type];
 }
 
-int Piece::attack_range() const {
-    if (type == "pawn") return 1;
-    if (type == "knight") return 1;
-    if (type == "bishop") return 8;
-    if (type == "rook") return 8;
-    if (type == "queen") return 8;
-    if (type == "king") return 1;
-    return 0.0;
+int piece_type_from_name(const std::string &name) {
+    return (int)(std::find(PIECE_TYPE_NAMES, PIECE_TYPE_NAMES + 6, name) - PIECE_TYPE_NAMES);
 }
 
-std::vector<Coordinate> Piece::attack_directions() const {
-    if (type == "pawn") return {};
-    if (type == "knight") return {{1, 2}, {1, -2}, {-1, 2}, {-1, -2}, {2, 1}, {2, -1}, {-2, 1}, {-2, -1}};
-    if (type == "bishop") return {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    if (type == "rook") return {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-    if (type == "queen") return {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    if (type == "king") return {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    return {};
+// castling rights that survive a move touching each square
+static int castling_rights_mask(int square) {
+    switch (square) {
+        case 0: return ~WHITE_QUEENSIDE;
+        case 4: return ~(WHITE_KINGSIDE | WHITE_QUEENSIDE);
+        case 7: return ~WHITE_KINGSIDE;
+        case 56: return ~BLACK_QUEENSIDE;
+        case 60: return ~(BLACK_KINGSIDE | BLACK_QUEENSIDE);
+        case 63: return ~BLACK_KINGSIDE;
+        default: return ~0;
+    }
 }
 
-std::string GameState::hash() const { // TODO: this hash doesn't take into account en passant and castling rights when hashing the state
-    std::string position_string;
-    for (int i = 0; i <= 7; i++) {
-        for (int j = 0; j <= 7; j++) {
-            Piece piece = board_state[i][j];
-            position_string += (piece.active ? piece.color + piece.type : "-");
+Position::Position() {
+    std::fill(board, board + 64, (uint8_t)NO_PIECE_TYPE);
+}
+
+int Position::king_square(int color) const {
+    return pieces[color][KING] ? lsb(pieces[color][KING]) : NO_SQUARE;
+}
+
+uint64_t Position::compute_key() const {
+    uint64_t position_key = 0;
+
+    for (int square = 0; square < 64; square++) {
+        if (board[square] != NO_PIECE_TYPE) {
+            position_key ^= ZOBRIST.pieces[color_on(square)][board[square]][square];
+        }
+    }
+
+    position_key ^= ZOBRIST.castling[castling_rights];
+    if (en_passant != NO_SQUARE) {
+        position_key ^= ZOBRIST.en_passant[file_of(en_passant)];
+    }
+    if (side_to_move == BLACK) {
+        position_key ^= ZOBRIST.side;
+    }
+
+    return position_key;
+}
+
+void Position::put_piece(int color, int piece_type, int square) {
+    pieces[color][piece_type] |= square_bit(square);
+    colors[color] |= square_bit(square);
+    board[square] = piece_type;
+    key ^= ZOBRIST.pieces[color][piece_type][square];
+
+    score_middlegame[color] += piece_square_value(PIECE_TABLES_MIDDLEGAME, MATERIAL_MIDDLEGAME, color, piece_type, square);
+    score_endgame[color] += piece_square_value(PIECE_TABLES_ENDGAME, MATERIAL_ENDGAME, color, piece_type, square);
+    phase += PHASE_WEIGHTS[piece_type];
+}
+
+void Position::remove_piece(int square) {
+    int color = color_on(square);
+    int piece_type = board[square];
+    key ^= ZOBRIST.pieces[color][piece_type][square];
+
+    score_middlegame[color] -= piece_square_value(PIECE_TABLES_MIDDLEGAME, MATERIAL_MIDDLEGAME, color, piece_type, square);
+    score_endgame[color] -= piece_square_value(PIECE_TABLES_ENDGAME, MATERIAL_ENDGAME, color, piece_type, square);
+    phase -= PHASE_WEIGHTS[piece_type];
+
+    pieces[color][piece_type] &= ~square_bit(square);
+    colors[color] &= ~square_bit(square);
+    board[square] = NO_PIECE_TYPE;
+}
+
+void Position::make_move(Move move) {
+    int us = side_to_move;
+    int them = us ^ 1;
+    int source = move.source();
+    int dest = move.dest();
+    int flags = move.flags();
+    int piece_type = board[source];
+
+    UndoInfo undo = {move, NO_PIECE_TYPE, castling_rights, en_passant, halfmove_clock, {castling_advantage[WHITE], castling_advantage[BLACK]}};
+    key_history.push_back(key);
+
+    if (flags == EN_PASSANT) { // the captured pawn is behind the destination square
+        undo.captured = PAWN;
+        remove_piece(dest + (us == WHITE ? -8 : 8));
+    }
+    else if (move.is_capture()) {
+        undo.captured = board[dest];
+        remove_piece(dest);
+    }
+
+    halfmove_clock = (undo.captured != NO_PIECE_TYPE || piece_type == PAWN ? 0 : halfmove_clock + 1);
+    moves++;
+
+    remove_piece(source);
+    put_piece(us, move.is_promotion() ? move.promotion() : piece_type, dest);
+
+    if (flags == KING_CASTLE || flags == QUEEN_CASTLE) { // move the rook as well
+        int rook_source = (flags == KING_CASTLE ? source + 3 : source - 4);
+        remove_piece(rook_source);
+        put_piece(us, ROOK, (source + dest) / 2);
+        castling_advantage[us] = 1;
+    }
+    else if (piece_type == KING && castling_advantage[us] == 0) { // first king move, and it isn't castling
+        castling_advantage[us] = -1;
+    }
+
+    key ^= ZOBRIST.castling[castling_rights];
+    castling_rights &= castling_rights_mask(source) & castling_rights_mask(dest);
+    key ^= ZOBRIST.castling[castling_rights];
+
+    // only record the en passant square if an opponent pawn can actually capture onto it
+    if (en_passant != NO_SQUARE) {
+        key ^= ZOBRIST.en_passant[file_of(en_passant)];
+    }
+    en_passant = NO_SQUARE;
+    if (flags == DOUBLE_PAWN_PUSH) {
+        int skipped_square = (source + dest) / 2;
+        if (pawn_attacks(us, skipped_square) & pieces[them][PAWN]) {
+            en_passant = skipped_square;
+            key ^= ZOBRIST.en_passant[file_of(en_passant)];
         }
     }
 
-    std::string state = to_move + position_string;
-    return std::to_string(std::hash<std::string>{}(state));
+    side_to_move = them;
+    key ^= ZOBRIST.side;
+    undo_stack.push_back(undo);
+}
+
+void Position::unmake_move() {
+    const UndoInfo &undo = undo_stack.back();
+    int us = side_to_move ^ 1;
+    int source = undo.move.source();
+    int dest = undo.move.dest();
+    int flags = undo.move.flags();
+
+    int piece_type = (undo.move.is_promotion() ? (int)PAWN : (int)board[dest]);
+    remove_piece(dest);
+    put_piece(us, piece_type, source);
+
+    if (flags == KING_CASTLE || flags == QUEEN_CASTLE) {
+        int rook_source = (flags == KING_CASTLE ? source + 3 : source - 4);
+        remove_piece((source + dest) / 2);
+        put_piece(us, ROOK, rook_source);
+    }
+
+    if (flags == EN_PASSANT) {
+        put_piece(us ^ 1, PAWN, dest + (us == WHITE ? -8 : 8));
+    }
+    else if (undo.captured != NO_PIECE_TYPE) {
+        put_piece(us ^ 1, undo.captured, dest);
+    }
+
+    castling_rights = undo.castling_rights;
+    en_passant = undo.en_passant;
+    halfmove_clock = undo.halfmove_clock;
+    castling_advantage[WHITE] = undo.castling_advantage[WHITE];
+    castling_advantage[BLACK] = undo.castling_advantage[BLACK];
+    key = key_history.back();
+    key_history.pop_back();
+    moves--;
+    side_to_move = us;
+
+    undo_stack.pop_back();
+}
+
+void Position::make_null_move() {
+    UndoInfo undo = {NO_MOVE, NO_PIECE_TYPE, castling_rights, en_passant, halfmove_clock, {castling_advantage[WHITE], castling_advantage[BLACK]}};
+    undo_stack.push_back(undo);
+    key_history.push_back(key);
+
+    halfmove_clock = 0; // a pass can't be part of a real repetition
+
+    if (en_passant != NO_SQUARE) {
+        key ^= ZOBRIST.en_passant[file_of(en_passant)];
+    }
+    en_passant = NO_SQUARE;
+    side_to_move ^= 1;
+    key ^= ZOBRIST.side;
+}
+
+void Position::unmake_null_move() {
+    en_passant = undo_stack.back().en_passant;
+    halfmove_clock = undo_stack.back().halfmove_clock;
+    key = key_history.back();
+    key_history.pop_back();
+    side_to_move ^= 1;
+
+    undo_stack.pop_back();
 }
 
-double GameState::eval() const {
-    double advantage = 0.0;
-    
+bool Position::is_repetition(int search_ply) const {
+    int size = (int)key_history.size();
+    int earliest = std::max(size - halfmove_clock, 0);
+
+    // the same side must be to move, and it takes two moves by each side to get back to a position
+    bool seen_before = false;
+    for (int i = size - 4; i >= earliest; i -= 2) {
+        if (key_history[i] == key) {
+            if (i >= size - search_ply || seen_before) {
+                return true;
+            }
+            seen_before = true;
+        }
+    }
+    return false;
+}
+
+int Position::eval() const {
+    PROFILE_SCOPE(evaluation_millis);
+    int us = side_to_move;
+    int them = us ^ 1;
+
+    int middlegame = score_middlegame[us] - score_middlegame[them];
+    int endgame = score_endgame[us] - score_endgame[them];
+
+    // mobility: squares each piece attacks that aren't taken by its own side
+    uint64_t occupancy = occupied();
+    for (int color:{us, them}) {
+        int sign = (color == us ? 1 : -1);
+        for (int piece_type = KNIGHT; piece_type <= QUEEN; piece_type++) {
+            uint64_t piece_bitboard = pieces[color][piece_type];
+            while (piece_bitboard) {
+                int square = pop_lsb(piece_bitboard);
+
+                uint64_t attacks = 0;
+                switch (piece_type) {
+                    case KNIGHT: attacks = knight_attacks(square); break;
+                    case BISHOP: attacks = bishop_attacks(square, occupancy); break;
+                    case ROOK: attacks = rook_attacks(square, occupancy); break;
+                    case QUEEN: attacks = queen_attacks(square, occupancy); break;
+                }
+                int mobility = pop_count(attacks & ~colors[color]);
+
+                middlegame += sign * MOBILITY_MIDDLEGAME[piece_type] * mobility;
+                endgame += sign * MOBILITY_ENDGAME[piece_type] * mobility;
+            }
+        }
+    }
+
+    middlegame += CASTLING_BONUS * (castling_advantage[us] - castling_advantage[them]);
+
+    int game_phase = std::min(phase, MAX_PHASE);
+    return (middlegame * game_phase + endgame * (MAX_PHASE - game_phase)) / MAX_PHASE;
+}
+
+Position GameState::to_position() const {
+    Position position;
+
+    position.side_to_move = (to_move == "white" ? WHITE : BLACK);
+    position.moves = moves;
+    position.halfmove_clock = moves - last_capture_or_pawn_move;
+    position.castling_advantage[WHITE] = (int)castling_advantage_white;
+    position.castling_advantage[BLACK] = (int)castling_advantage_black;
+
     for (int i = 0; i <= 7; i++) {
         for (int j = 0; j <= 7; j++) {
-            Piece piece = board_state[i][j];
+            const Piece &piece = board_state[i][j];
             if (piece.active) {
-                if (piece.color == to_move) {
-                    advantage += piece.value();
-                }
-                else {
-                    advantage -= piece.value();
-                }
+                position.put_piece(piece.color == "white" ? WHITE : BLACK, piece_type_from_name(piece.type), make_square(i, j));
             }
         }
     }
 
-    return advantage;
-}
-
-EMSCRIPTEN_BINDINGS(structs) {
-    register_vector<std::string>("StringVector");
-    register_vector<Piece>("PieceVector");
-    register_vector<std::vector<Piece>>("PieceVectorVector");
-    register_map<std::string, int>("StringIntMap");
-    
-    value_object<Coordinate>("Coordinate")
-        .field("i", &Coordinate::i)
-        .field("j", &Coordinate::j)
-        ;
-    value_object<Square>("Square")
-        .field("file", &Square::file)
-        .field("rank", &Square::rank)
-        ;
-    value_object<Move>("Move")
-        .field("source", &Move::source)
-        .field("dest", &Move::dest)
-        .field("newPieceType", &Move::new_piece_type)
-        ;
-    value_object<Piece>("Piece")
-        .field("active", &Piece::active)
-        .field("color", &Piece::color)
-        .field("type", &Piece::type)
-        .field("moves", &Piece::moves)
-        .field("lastMoveIndex", &Piece::last_move_index)
-        ;
-    value_object<GameState>("GameState")
-        .field("moves", &GameState::moves)
-        .field("previousStates", &GameState::previous_states)
-        .field("lastCaptureOrPawnMove", &GameState::last_capture_or_pawn_move)
-        .field("toMove", &GameState::to_move)
-        .field("castlingAdvantageWhite", &GameState::castling_advantage_white)
-        .field("castlingAdvantageBlack", &GameState::castling_advantage_black)
-        .field("boardState", &GameState::board_state)
-        ;
-    value_object<PossibleMove>("PossibleMove")
-        .field("move", &PossibleMove::move)
-        .field("gameState", &PossibleMove::game_state)
-        ;
+    // a side may castle with a rook if neither the king nor that rook has moved
+    for (std::string color:{"white", "black"}) {
+        int rank = (color == "white" ? 0 : 7);
+        const Piece &king = board_state[4][rank];
+        if (!king.active || king.type != "king" || king.color != color || king.last_move_index != 0) {
+            continue;
+        }
+
+        for (int rook_file:{0, 7}) {
+            const Piece &rook = board_state[rook_file][rank];
+            if (rook.active && rook.type == "rook" && rook.color == color && rook.last_move_index == 0) {
+                position.castling_rights |= (rook_file == 7 ? WHITE_KINGSIDE : WHITE_QUEENSIDE) << (color == "white" ? 0 : 2);
+            }
+        }
+    }
+
+    // the opponent's last move was a double pawn push that we can capture en passant
+    int them = position.side_to_move ^ 1;
+    int pushed_rank = (them == WHITE ? 3 : 4);
+    for (int i = 0; i <= 7; i++) {
+        const Piece &piece = board_state[i][pushed_rank];
+        if (piece.active && piece.type == "pawn" && piece.color != to_move && piece.last_move_index == moves && piece.moves == 1) {
+            int skipped_square = make_square(i, pushed_rank + (them == WHITE ? -1 : 1));
+            if (pawn_attacks(them, skipped_square) & position.pieces[position.side_to_move][PAWN]) {
+                position.en_passant = skipped_square;
+            }
+        }
+    }
+
+    position.key = position.compute_key();
+
+    // everything but this position's own key is history
+    position.key_history = key_history;
+    if (!position.key_history.empty() && position.key_history.back() == position.key) {
+        position.key_history.pop_back();
+    }
+
+    return position;
+}
+
+// the piece move counters are made up so that to_position finds the same castling rights and en passant square
+GameState GameState::from_position(const Position &position) {
+    GameState game_state;
+    game_state.moves = position.moves;
+    game_state.last_capture_or_pawn_move = position.moves - position.halfmove_clock;
+    game_state.to_move = (position.side_to_move == WHITE ? "white" : "black");
+    game_state.castling_advantage_white = position.castling_advantage[WHITE];
+    game_state.castling_advantage_black = position.castling_advantage[BLACK];
+
+    // a king or rook that can still castle has never moved; nothing else moved on this game's move counter
+    uint64_t unmoved = 0;
+    const int CASTLING_SQUARES[4][2] = {{4, 7}, {4, 0}, {60, 63}, {60, 56}};
+    for (int i = 0; i < 4; i++) {
+        if (position.castling_rights & (1 << i)) {
+            unmoved |= square_bit(CASTLING_SQUARES[i][0]) | square_bit(CASTLING_SQUARES[i][1]);
+        }
+    }
+
+    int pushed_pawn = NO_SQUARE;
+    if (position.en_passant != NO_SQUARE) {
+        pushed_pawn = position.en_passant + (position.side_to_move == WHITE ? -8 : 8);
+    }
+
+    for (int square = 0; square < 64; square++) {
+        if (position.board[square] == NO_PIECE_TYPE) {
+            continue;
+        }
+
+        Piece &piece = game_state.board_state[file_of(square)][rank_of(square)];
+        piece.active = true;
+        piece.color = (position.color_on(square) == WHITE ? "white" : "black");
+        piece.type = piece_type_name(position.board[square]);
+        piece.moves = (unmoved & square_bit(square) ? 0 : 1);
+        piece.last_move_index = (unmoved & square_bit(square) ? 0 : -1);
+        if (square == pushed_pawn) {
+            piece.last_move_index = position.moves;
+        }
+    }
+
+    game_state.key_history = {position.key};
+    return game_state;
+}
+
+GameState GameState::after_move(Move move, uint64_t new_key) const {
+    int source = move.source();
+    int dest = move.dest();
+
+    Coordinate source_coord = {file_of(source), rank_of(source)};
+    Coordinate dest_coord = {file_of(dest), rank_of(dest)};
+
+    const Piece &piece = board_state[source_coord.i][source_coord.j];
+    const Piece &dest_piece = board_state[dest_coord.i][dest_coord.j];
+
+    GameState new_game_state = *this;
+    new_game_state.moves = moves + 1;
+
+    if (dest_piece.active || piece.type == "pawn") { // none of the earlier positions can come back
+        new_game_state.last_capture_or_pawn_move = moves + 1;
+        new_game_state.key_history.clear();
+    }
+
+    if (piece.type == "pawn" && source_coord.i != dest_coord.i && !dest_piece.active) { // en passant: delete opponent pawn
+        new_game_state.board_state[dest_coord.i][source_coord.j].active = false;
+    }
+
+    if (piece.type == "king" && std::abs(dest_coord.i - source_coord.i) == 2) { // castling: move rook
+        int rook_file = (dest_coord.i > source_coord.i ? 7 : 0);
+        int rook_dest_file = (source_coord.i + dest_coord.i) / 2;
+        Piece rook = board_state[rook_file][source_coord.j];
+        rook.last_move_index = moves + 1;
+
+        new_game_state.board_state[rook_file][source_coord.j].active = false;
+        new_game_state.board_state[rook_dest_file][source_coord.j] = rook;
+        (to_move == "white" ? new_game_state.castling_advantage_white : new_game_state.castling_advantage_black) = 1.0;
+    }
+    else if (piece.type == "king" && piece.moves == 0) {
+        (to_move == "white" ? new_game_state.castling_advantage_white : new_game_state.castling_advantage_black) = -1.0;
+    }
+
+    // move piece
+    new_game_state.board_state[source_coord.i][source_coord.j].active = false;
+    new_game_state.board_state[dest_coord.i][dest_coord.j] = piece;
+    if (move.is_promotion()) {
+        new_game_state.board_state[dest_coord.i][dest_coord.j].type = piece_type_name(move.promotion());
+    }
+    new_game_state.board_state[dest_coord.i][dest_coord.j].moves = piece.moves + 1;
+    new_game_state.board_state[dest_coord.i][dest_coord.j].last_move_index = moves + 1;
+
+    new_game_state.to_move = (to_move == "white" ? "black" : "white");
+    new_game_state.key_history.push_back(new_key);
+
+    return new_game_state;
 }
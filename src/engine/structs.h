@@ -1,10 +1,54 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
-#include <map>
 #include <functional>
 
+enum Color {
+    WHITE,
+    BLACK
+};
+
+enum PieceType {
+    PAWN,
+    KNIGHT,
+    BISHOP,
+    ROOK,
+    QUEEN,
+    KING,
+    NO_PIECE_TYPE
+};
+
+enum CastlingRight {
+    WHITE_KINGSIDE = 1,
+    WHITE_QUEENSIDE = 2,
+    BLACK_KINGSIDE = 4,
+    BLACK_QUEENSIDE = 8
+};
+
+enum MoveFlag {
+    QUIET,
+    DOUBLE_PAWN_PUSH,
+    KING_CASTLE,
+    QUEEN_CASTLE,
+    CAPTURE,
+    EN_PASSANT,
+    KNIGHT_PROMOTION = 8,
+    BISHOP_PROMOTION,
+    ROOK_PROMOTION,
+    QUEEN_PROMOTION,
+    KNIGHT_PROMOTION_CAPTURE,
+    BISHOP_PROMOTION_CAPTURE,
+    ROOK_PROMOTION_CAPTURE,
+    QUEEN_PROMOTION_CAPTURE
+};
+
+const int NO_SQUARE = 64;
+const int MAX_MOVES = 256;
+
+const int PIECE_VALUES[6] = {100, 300, 300, 500, 900, 10000}; // centipawns
+
 struct Coordinate {
     int i = 0;
     int j = 0;
@@ -26,7 +70,7 @@ struct Square {
     }
 };
 
-struct Move {
+struct SquareMove {
     Square source = {"a", "1"};
     Square dest = {"a", "1"};
     std::string new_piece_type = "pawn";
@@ -40,16 +84,151 @@ struct Piece {
 
     int moves = 0;
     int last_move_index = 0;
+};
+
+std::string piece_type_name(int piece_type);
+int piece_type_from_name(const std::string &name);
+
+// compact move: source square in bits 0-5, destination in bits 6-11, MoveFlag in bits 12-15
+struct Move {
+    uint16_t data = 0;
+
+    Move() = default;
+    Move(int source, int dest, int flags = QUIET) : data((uint16_t)(source | (dest << 6) | (flags << 12))) {}
+
+    int source() const {
+        return data & 63;
+    }
+    int dest() const {
+        return (data >> 6) & 63;
+    }
+    int flags() const {
+        return data >> 12;
+    }
+
+    bool is_capture() const {
+        return flags() & CAPTURE;
+    }
+    bool is_promotion() const {
+        return flags() & KNIGHT_PROMOTION;
+    }
+    // captures and promotions change the material balance; everything else is a quiet move
+    bool is_noisy() const {
+        return is_capture() || is_promotion();
+    }
+    int promotion() const {
+        return KNIGHT + (flags() & 3);
+    }
+
+    bool operator==(const Move& b) const {
+        return data == b.data;
+    }
+    bool operator!=(const Move& b) const {
+        return data != b.data;
+    }
+};
+
+const Move NO_MOVE = Move();
+
+// fixed-capacity move list, so generating moves never allocates
+struct MoveList {
+    Move moves[MAX_MOVES];
+    int size = 0;
 
-    double value() const;
+    void push_back(Move move) {
+        moves[size++] = move;
+    }
+    bool empty() const {
+        return size == 0;
+    }
+
+    Move &operator[](int index) {
+        return moves[index];
+    }
+    Move *begin() {
+        return moves;
+    }
+    Move *end() {
+        return moves + size;
+    }
+};
 
-    int attack_range() const;
-    std::vector<Coordinate> attack_directions() const;
+// everything make_move overwrites that can't be recomputed when unmaking the move
+struct UndoInfo {
+    Move move;
+    int captured = NO_PIECE_TYPE;
+    int castling_rights = 0;
+    int en_passant = NO_SQUARE;
+    int halfmove_clock = 0;
+    int castling_advantage[2] = {0, 0};
+};
+
+// native board representation used by move generation and search
+// squares are indexed 0..63 with a1 = 0, b1 = 1, ..., h8 = 63
+struct Position {
+    uint64_t pieces[2][6] = {}; // one bitboard per color and piece type
+    uint64_t colors[2] = {};
+    uint8_t board[64]; // piece type on each square, for fast lookups
+
+    int side_to_move = WHITE;
+    int castling_rights = 0;
+    int en_passant = NO_SQUARE; // square a pawn can capture onto en passant
+    int halfmove_clock = 0;
+    int moves = 0;
+
+    int castling_advantage[2] = {0, 0}; // 1 if castled, -1 if the king moved without castling
+
+    uint64_t key = 0; // Zobrist key, kept up to date by every change to the position
+
+    // material and piece-square scores of each color, and the game phase; kept up to date by put_piece and remove_piece
+    int score_middlegame[2] = {0, 0};
+    int score_endgame[2] = {0, 0};
+    int phase = 0;
+
+    std::vector<UndoInfo> undo_stack;
+
+    // keys of the positions each move was played from, oldest first, for restoring the key and finding repetitions
+    // may start with earlier positions of the game that the undo stack doesn't go back to
+    std::vector<uint64_t> key_history;
+
+    Position();
+
+    uint64_t occupied() const {
+        return colors[WHITE] | colors[BLACK];
+    }
+
+    int color_on(int square) const {
+        return (colors[BLACK] >> square) & 1;
+    }
+
+    int king_square(int color) const;
+
+    // Zobrist key computed from scratch, for setting up a position
+    uint64_t compute_key() const;
+
+    void put_piece(int color, int piece_type, int square);
+    void remove_piece(int square);
+
+    // play a move in place without checking legality, and take it back again
+    void make_move(Move move);
+    void unmake_move();
+
+    // pass the turn to the opponent
+    void make_null_move();
+    void unmake_null_move();
+
+    // has this position occurred before since the last irreversible move? once is enough if that was within the last
+    // search_ply moves, as a side that can repeat once can repeat again; earlier game positions need two, as in the rules
+    bool is_repetition(int search_ply) const;
+
+    // static evaluation for the player to move, in centipawns: material, piece-square tables, mobility and castling,
+    // tapered between middlegame and endgame weights by the material left on the board
+    int eval() const;
 };
 
 struct GameState {
     int moves = 0;
-    std::map<std::string, int> previous_states;
+    std::vector<uint64_t> key_history; // position keys since the last capture or pawn move, ending with this one
     int last_capture_or_pawn_move = 0;
     std::string to_move = "white";
 
@@ -57,21 +236,24 @@ struct GameState {
     double castling_advantage_black = 0.0;
 
     std::vector<std::vector<Piece>> board_state = std::vector<std::vector<Piece>>(8, std::vector<Piece>(8));
-    
+
     GameState() = default;
 
-    GameState(int _moves, std::map<std::string, int> _previous_states, int _last_capture_or_pawn_move, std::string _to_move, std::vector<std::vector<Piece>> _board_state) {
+    GameState(int _moves, std::vector<uint64_t> _key_history, int _last_capture_or_pawn_move, std::string _to_move, std::vector<std::vector<Piece>> _board_state) {
         moves = _moves;
-        previous_states = _previous_states;
+        key_history = _key_history;
         to_move = _to_move;
         board_state = _board_state;
     }
 
-    std::string hash() const;
-    double eval() const;
+    // conversions between the Embind representation and the native one
+    Position to_position() const;
+    static GameState from_position(const Position &position);
+    // new_key is the key of the position after the move, which the caller has from playing it on a Position
+    GameState after_move(Move move, uint64_t new_key) const;
 };
 
 struct PossibleMove {
-    Move move;
+    SquareMove move;
     GameState game_state;
 };
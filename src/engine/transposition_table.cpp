@@ -0,0 +1,116 @@
+#include <algorithm>
+
+#include "transposition_table.h"
+
+TranspositionTable transposition_table;
+thread_local TTStats TranspositionTable::stats;
+
+const uint64_t GENERATION_MASK = 63;
+
+static uint64_t pack_entry(const TTEntry &entry) {
+    return (uint64_t)(uint32_t)entry.score |
+        (uint64_t)entry.move.data << 32 |
+        (uint64_t)(uint8_t)entry.depth << 48 |
+        (uint64_t)(entry.bound & 3) << 56 |
+        (uint64_t)(entry.generation & GENERATION_MASK) << 58;
+}
+
+static TTEntry unpack_entry(uint64_t key, uint64_t data) {
+    TTEntry entry;
+    entry.key = key;
+    entry.score = (int32_t)(uint32_t)data;
+    entry.move.data = (uint16_t)(data >> 32);
+    entry.depth = (int8_t)(data >> 48);
+    entry.bound = (data >> 56) & 3;
+    entry.generation = (data >> 58) & GENERATION_MASK;
+    return entry;
+}
+
+bool TTSlot::load(TTEntry &entry) const {
+    uint64_t slot_data = data.load(std::memory_order_relaxed);
+    uint64_t slot_key = key_xor_data.load(std::memory_order_relaxed) ^ slot_data;
+    entry = unpack_entry(slot_key, slot_data);
+    return entry.bound != BOUND_NONE;
+}
+
+void TTSlot::save(const TTEntry &entry) {
+    uint64_t slot_data = pack_entry(entry);
+    data.store(slot_data, std::memory_order_relaxed);
+    key_xor_data.store(entry.key ^ slot_data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+    size_t bucket_count = 1;
+    while (bucket_count * 2 * sizeof(TTBucket) <= std::max(megabytes, (size_t)1) * 1024 * 1024) {
+        bucket_count *= 2;
+    }
+
+    buckets.reset(new TTBucket[bucket_count]);
+    index_mask = bucket_count - 1;
+    size_megabytes = (double)(bucket_count * sizeof(TTBucket)) / (1024 * 1024);
+}
+
+void TranspositionTable::clear() {
+    for (uint64_t i = 0; i <= index_mask; i++) {
+        buckets[i].depth_preferred.save(TTEntry());
+        buckets[i].always_replace.save(TTEntry());
+    }
+    generation = 0;
+}
+
+void TranspositionTable::new_search() {
+    generation++;
+    stats = TTStats();
+}
+
+TTStats TranspositionTable::current_stats() const {
+    TTStats current = stats;
+    current.size_megabytes = size_megabytes;
+    return current;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry &entry) {
+    const TTBucket &bucket = buckets[key & index_mask];
+    stats.probes++;
+
+    for (const TTSlot *slot:{&bucket.depth_preferred, &bucket.always_replace}) {
+        TTEntry candidate;
+        if (slot->load(candidate) && candidate.key == key) {
+            stats.hits++;
+            entry = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, int bound, Move move) {
+    TTBucket &bucket = buckets[key & index_mask];
+    TTEntry new_entry = {key, score, move, (int8_t)depth, (uint8_t)bound, (uint8_t)(generation & GENERATION_MASK)};
+    stats.stores++;
+
+    TTEntry deep, recent;
+    bool deep_used = bucket.depth_preferred.load(deep);
+    bool recent_used = bucket.always_replace.load(recent);
+
+    // keep the best move we already know for this position if we don't have one now
+    for (const TTEntry &existing:{deep, recent}) {
+        if (existing.key == key && move == NO_MOVE) {
+            new_entry.move = existing.move;
+        }
+    }
+
+    if (!deep_used || deep.key == key || deep.generation != new_entry.generation || depth >= deep.depth) {
+        if (deep_used && deep.key != key) {
+            stats.overwrites++;
+        }
+        bucket.depth_preferred.save(new_entry);
+    }
+    else {
+        if (recent_used && recent.key != key) {
+            stats.overwrites++;
+        }
+        bucket.always_replace.save(new_entry);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include "structs.h"
+
+enum Bound {
+    BOUND_NONE,
+    BOUND_UPPER, // the score is at most the stored score
+    BOUND_LOWER, // the score is at least the stored score
+    BOUND_EXACT
+};
+
+struct TTEntry {
+    uint64_t key = 0;
+    int32_t score = 0;
+    Move move;
+    int8_t depth = 0;
+    uint8_t bound = BOUND_NONE;
+    uint8_t generation = 0;
+};
+
+// an entry packed into one word (score, move, depth, bound, generation), stored next to key ^ data
+// search threads read and write slots without locking: a slot torn by a concurrent store no longer
+// matches its key, so it reads as a miss rather than as another position's entry
+struct TTSlot {
+    std::atomic<uint64_t> key_xor_data{0};
+    std::atomic<uint64_t> data{0};
+
+    bool load(TTEntry &entry) const;
+    void save(const TTEntry &entry);
+};
+
+// each bucket keeps the deepest recent result for its slot, plus whatever was stored last
+struct TTBucket {
+    TTSlot depth_preferred;
+    TTSlot always_replace;
+};
+
+// counters since the last search started, for the thread that started it; doubles so they cross the Embind boundary as plain numbers
+struct TTStats {
+    double probes = 0;
+    double hits = 0;
+    double stores = 0;
+    double overwrites = 0; // stores that evicted a different position
+    double size_megabytes = 0;
+};
+
+const size_t DEFAULT_HASH_MEGABYTES = 16;
+
+// shared by every search thread
+struct TranspositionTable {
+    std::unique_ptr<TTBucket[]> buckets;
+    uint64_t index_mask = 0;
+    uint8_t generation = 0; // only the low 6 bits are stored in entries
+    double size_megabytes = 0;
+
+    static thread_local TTStats stats; // per thread, so helper threads don't contend on the counters
+
+    TranspositionTable() {
+        resize(DEFAULT_HASH_MEGABYTES);
+    }
+
+    // rounds the memory budget down to a power-of-two number of buckets, and empties the table
+    void resize(size_t megabytes);
+    void clear();
+    void new_search(); // call before the search threads start
+
+    TTStats current_stats() const;
+
+    bool probe(uint64_t key, TTEntry &entry);
+    void store(uint64_t key, int depth, int score, int bound, Move move);
+};
+
+extern TranspositionTable transposition_table;
@@ -1,6 +1,4 @@
-#include <numeric>
-
-#include "structs.h"
+#include "utils.h"
 
 Coordinate square_to_coord(Square square) {
     Coordinate coord;
@@ -18,16 +16,11 @@ bool valid_coord(Coordinate coord) {
     return 0 <= coord.i && coord.i <= 7 && 0 <= coord.j && coord.j <= 7;
 }
 
-Coordinate simplified_direction_vector(Coordinate source, Coordinate dest) {
-    if (source == dest) {
-        return {0, 0};
-    }
-
-    Coordinate difference_vector = dest - source;
-    int GCD = abs(std::gcd(difference_vector.i, difference_vector.j));
-
-    difference_vector.i /= GCD;
-    difference_vector.j /= GCD;
+int square_to_index(Square square) {
+    Coordinate coord = square_to_coord(square);
+    return make_square(coord.i, coord.j);
+}
 
-    return difference_vector;
+Square index_to_square(int index) {
+    return coord_to_square({file_of(index), rank_of(index)});
 }
@@ -1,8 +1,43 @@
 #pragma once
 
+#include <cstdint>
+
 #include "structs.h"
 
 Coordinate square_to_coord(Square square);
 Square coord_to_square(Coordinate coord);
 bool valid_coord(Coordinate coord);
-Coordinate simplified_direction_vector(Coordinate source, Coordinate dest);
+
+int square_to_index(Square square);
+Square index_to_square(int index);
+
+// bitboard helpers: bit n of a bitboard is the square with file n % 8 and rank n / 8 (a1 = 0, h8 = 63)
+inline int make_square(int file, int rank) {
+    return rank * 8 + file;
+}
+
+inline int file_of(int square) {
+    return square & 7;
+}
+
+inline int rank_of(int square) {
+    return square >> 3;
+}
+
+inline uint64_t square_bit(int square) {
+    return 1ULL << square;
+}
+
+inline int pop_count(uint64_t bitboard) {
+    return __builtin_popcountll(bitboard);
+}
+
+inline int lsb(uint64_t bitboard) {
+    return __builtin_ctzll(bitboard);
+}
+
+inline int pop_lsb(uint64_t &bitboard) {
+    int square = lsb(bitboard);
+    bitboard &= bitboard - 1;
+    return square;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+// random keys XORed together to identify a position; see Position::key
+struct ZobristKeys {
+    uint64_t pieces[2][6][64];
+    uint64_t castling[16]; // indexed by the full set of castling rights
+    uint64_t en_passant[8]; // indexed by the file of the en passant square
+    uint64_t side; // included when black is to move
+};
+
+constexpr uint64_t splitmix64(uint64_t &state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys generate_zobrist_keys() {
+    ZobristKeys keys = {};
+    uint64_t state = 0x2545F4914F6CDD1DULL; // fixed seed, so keys are the same in every build
+
+    for (int color = 0; color < 2; color++) {
+        for (int piece_type = 0; piece_type < 6; piece_type++) {
+            for (int square = 0; square < 64; square++) {
+                keys.pieces[color][piece_type][square] = splitmix64(state);
+            }
+        }
+    }
+
+    // castling keys are combinations of one key per right, so updating them is a single XOR
+    uint64_t castling_right_keys[4] = {splitmix64(state), splitmix64(state), splitmix64(state), splitmix64(state)};
+    for (int rights = 0; rights < 16; rights++) {
+        for (int right = 0; right < 4; right++) {
+            if (rights & (1 << right)) {
+                keys.castling[rights] ^= castling_right_keys[right];
+            }
+        }
+    }
+
+    for (int file = 0; file < 8; file++) {
+        keys.en_passant[file] = splitmix64(state);
+    }
+    keys.side = splitmix64(state);
+
+    return keys;
+}
+
+inline constexpr ZobristKeys ZOBRIST = generate_zobrist_keys();
@@ -0,0 +1,57 @@
+import type { PieceType, PlayerColor } from "../types/types";
+
+const pieceTypes: PieceType[] = ["pawn", "knight", "bishop", "rook", "queen", "king"];
+
+// moves come from the engine as 16-bit codes: source square in bits 0-5, destination in bits 6-11, flags in bits 12-15
+export function moveSource(code: number) {
+    return code & 63;
+}
+
+export function moveDest(code: number) {
+    return (code >> 6) & 63;
+}
+
+export function movePromotion(code: number): PieceType | null {
+    return (code & 0x8000) ? pieceTypes[1 + ((code >> 12) & 3)] : null;
+}
+
+// the engine's board squares hold color * 6 + piece type, or EMPTY_SQUARE
+export function squarePiece(code: number): { color: PlayerColor; type: PieceType } | null {
+    if (code >= 12) return null;
+    return { color: code < 6 ? "white" : "black", type: pieceTypes[code % 6] };
+}
+
+// takes back the moves of played that aren't in moves, then plays the rest of moves, stopping at an illegal one;
+// returns the moves now played, for the next call
+export function catchUp(played: number[], moves: number[], undo: () => boolean, play: (code: number) => boolean) {
+    let common = 0;
+    while (common < played.length && common < moves.length && played[common] === moves[common]) {
+        common++;
+    }
+
+    for (let i = played.length; i > common; i--) {
+        undo();
+    }
+
+    let index = common;
+    while (index < moves.length && play(moves[index])) {
+        index++;
+    }
+    return moves.slice(0, index);
+}
+
+const boards = new WeakMap<object, { board: any; played: number[] }>();
+
+// one board per engine module, reused for every query: it follows the game from the starting position
+// by the codes of the moves played, so only the moves made since the last query cross into Wasm
+export function boardAfter(engine: any, moves: number[]) {
+    let entry = boards.get(engine);
+    if (!entry) {
+        entry = { board: new engine.Board(), played: [] };
+        boards.set(engine, entry);
+    }
+
+    const board = entry.board;
+    entry.played = catchUp(entry.played, moves, () => board.undo(), code => board.play(code));
+    return board;
+}
@@ -1,56 +1,36 @@
-import type { GameState, PlayerColor } from "../types/types";
+import type { PlayerColor } from "../types/types";
 
-import { toEngineGameState } from "../utils/jsEmbindConverter";
+import { boardAfter } from "./engineBoard";
 
-function isCheckmate(engine: any, gameState: GameState) {
-    if (!engine.isCheckmate) return false;
-    return engine.isCheckmate(toEngineGameState(engine, gameState));
-}
-
-function isStalemate(engine: any, gameState: GameState) {
-    if (!engine.isStalemate) return false;
-    return engine.isStalemate(toEngineGameState(engine, gameState));
-}
-
-function threefoldRepetition(engine: any, gameState: GameState) {
-    if (!engine.threefoldRepetition) return false;
-    return engine.threefoldRepetition(toEngineGameState(engine, gameState));
-}
-
-function fiftyMoveRule(engine: any, gameState: GameState) {
-    if (!engine.fiftyMoveRule) return false;
-    return engine.fiftyMoveRule(toEngineGameState(engine, gameState));
-}
+// one engine call works out whether and how the game has ended, repetitions included; null until the engine has loaded
+function gameStatus(engine: any, moves: number[]) {
+    if (!engine.Board) return null;
 
-function insufficientMaterial(engine: any, gameState: GameState): boolean {
-    if (!engine.insufficientMaterial) return false;
-    return engine.insufficientMaterial(toEngineGameState(engine, gameState));
+    return boardAfter(engine, moves).status();
 }
 
-function isDraw(engine: any, gameState: GameState): boolean {
-    if (!engine.isDraw) return false;
-    return engine.isDraw(toEngineGameState(engine, gameState));
+export function isGameOver(engine: any, moves: number[]) {
+    const status = gameStatus(engine, moves);
+    return status !== null && status !== engine.GameStatus.IN_PROGRESS;
 }
 
-export function isGameOver(engine: any, gameState: GameState) {
-    return isCheckmate(engine, gameState) || isDraw(engine, gameState);
-}
-
-export function gameResult(engine: any, gameState: GameState, playerColor: PlayerColor) {
-    if (isCheckmate(engine, gameState)) {
-        return `${gameState.toMove === playerColor ? "Computer" : "You"} won by checkmate.`;
-    }
-    if (isStalemate(engine, gameState)) {
-        return "Draw by stalemate."
-    }
-    if (threefoldRepetition(engine, gameState)) {
-        return "Draw by repetition.";
-    }
-    if (fiftyMoveRule(engine, gameState)) {
-        return "Draw by 50-move rule.";
-    }
-    if (insufficientMaterial(engine, gameState)) {
-        return "Draw by insufficient material.";
+export function gameResult(engine: any, moves: number[], playerColor: PlayerColor) {
+    switch (gameStatus(engine, moves)) {
+        case engine.GameStatus.CHECKMATE:
+            return `${sideToMove(moves) === playerColor ? "Computer" : "You"} won by checkmate.`;
+        case engine.GameStatus.STALEMATE:
+            return "Draw by stalemate.";
+        case engine.GameStatus.THREEFOLD_REPETITION:
+            return "Draw by repetition.";
+        case engine.GameStatus.FIFTY_MOVE_RULE:
+            return "Draw by 50-move rule.";
+        case engine.GameStatus.INSUFFICIENT_MATERIAL:
+            return "Draw by insufficient material.";
     }
     return "Game has not ended. You should not be seeing this.";
 }
+
+// every game starts from the starting position
+export function sideToMove(moves: number[]): PlayerColor {
+    return moves.length % 2 === 0 ? "white" : "black";
+}
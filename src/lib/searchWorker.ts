@@ -0,0 +1,167 @@
+import type { SearchStats } from "../types/types";
+
+// games start from the starting position, so the moves played since (as the engine's move codes) are all the worker needs
+export type SearchWorkerRequest =
+    | { type: "init"; stopBuffer: SharedArrayBuffer | null; threads: number }
+    | { type: "search"; id: number; moves: number[]; millis: number; ponderId: number | null }
+    | { type: "ponderhit"; id: number; ponderId: number }; // the reply ponder search id expected was played: ponder on after its move as ponderId
+
+export type SearchWorkerResponse =
+    | { type: "progress"; id: number; depth: number; score: number; move: number; stats: SearchStats }
+    | { type: "result"; id: number; move: number | null }
+    | { type: "pondering"; id: number; moves: number[] }; // searching the position after these moves, which end with the expected reply
+
+interface PendingSearch {
+    id: number;
+    resolve: (move: number | null) => void;
+    bestSoFar: number | null;
+}
+
+interface Ponder {
+    id: number;
+    moves: number[];
+    bestSoFar: number | null;
+    result?: number | null; // set if the ponder search finished before the player moved
+}
+
+function sameMoves(a: number[], b: number[]) {
+    return a.length === b.length && a.every((code, i) => code === b[i]);
+}
+
+// runs engine searches in a dedicated worker so the page stays responsive while the computer thinks
+export class SearchWorker {
+    private worker: Worker;
+    private nextId = 0;
+    private pending: PendingSearch | null = null;
+    private pondering: Ponder | null = null;
+    private ponderId: number | null = null; // handed to the worker for its next ponder search, until it reports starting it
+
+    // of the latest search iteration, pondering included, for tuning the engine from the console
+    lastStats: SearchStats | null = null;
+
+    // holds the id of the latest search asked to stop, then the id of the latest ponder hit; the worker polls both mid-search
+    // shared memory needs cross-origin isolation, so without it a stopped worker is replaced instead, and the engine doesn't ponder
+    private stopFlag: Int32Array | null = (typeof SharedArrayBuffer !== "undefined" && crossOriginIsolated) ? new Int32Array(new SharedArrayBuffer(8)) : null;
+
+    constructor() {
+        this.worker = this.spawn();
+    }
+
+    computerMove(moves: number[], millis: number): Promise<number | null> {
+        if (this.pending) { // only one search at a time: the previous caller has moved on
+            this.stop();
+            this.pending?.resolve(null);
+        }
+
+        // after its move the worker searches on as if the player had made the reply it expects
+        const ponder = this.pondering;
+        if (ponder && this.stopFlag && sameMoves(ponder.moves, moves)) {
+            // ponder hit: that search becomes this one, and once it has its move the worker ponders on the next reply
+            this.pondering = null;
+            this.ponderId = ++this.nextId;
+            this.post({ type: "ponderhit", id: ponder.id, ponderId: this.ponderId });
+            if (ponder.result !== undefined) {
+                return Promise.resolve(ponder.result);
+            }
+            Atomics.store(this.stopFlag, 1, ponder.id);
+            return new Promise(resolve => {
+                this.pending = { id: ponder.id, resolve, bestSoFar: ponder.bestSoFar };
+            });
+        }
+        this.stopPondering(); // the transposition table it filled still helps the real search
+
+        const id = ++this.nextId;
+        const ponderId = this.stopFlag ? ++this.nextId : null;
+        this.ponderId = ponderId;
+        return new Promise(resolve => {
+            this.pending = { id, resolve, bestSoFar: null };
+            this.post({ type: "search", id, moves, millis, ponderId });
+        });
+    }
+
+    // ends the current search early; its promise resolves with the best move found so far
+    stop() {
+        if (!this.pending) return;
+
+        if (this.stopFlag) {
+            Atomics.store(this.stopFlag, 0, this.pending.id);
+            return;
+        }
+
+        this.worker.terminate();
+        this.finish(this.pending.bestSoFar);
+        this.worker = this.spawn();
+    }
+
+    // the game is over or was reset, so the reply being pondered on won't come; a ponder search the worker has yet to start
+    // stops as soon as it does
+    stopPondering() {
+        const id = Math.max(this.pondering?.id ?? 0, this.ponderId ?? 0);
+        if (id > 0 && this.stopFlag) {
+            Atomics.store(this.stopFlag, 0, Math.max(Atomics.load(this.stopFlag, 0), id));
+        }
+        this.pondering = null;
+        this.ponderId = null;
+    }
+
+    terminate() {
+        this.worker.terminate();
+        this.pondering = null;
+        this.ponderId = null;
+        this.finish(null);
+    }
+
+    private spawn() {
+        const worker = new Worker(new URL("../workers/searchWorker.ts", import.meta.url), { type: "module" });
+        worker.onmessage = (event: MessageEvent<SearchWorkerResponse>) => this.handleResponse(event.data);
+        worker.postMessage({
+            type: "init",
+            stopBuffer: this.stopFlag ? this.stopFlag.buffer as SharedArrayBuffer : null,
+            threads: crossOriginIsolated ? navigator.hardwareConcurrency : 1 // a threaded engine build needs shared memory too
+        } as SearchWorkerRequest);
+        return worker;
+    }
+
+    private post(request: SearchWorkerRequest) {
+        this.worker.postMessage(request);
+    }
+
+    private finish(move: number | null) {
+        const pending = this.pending;
+        this.pending = null;
+        pending?.resolve(move);
+    }
+
+    private handleResponse(response: SearchWorkerResponse) {
+        if (response.type === "progress") {
+            this.lastStats = response.stats;
+        }
+
+        if (response.type === "pondering") {
+            if (response.id === this.ponderId) { // otherwise it was stopped before it started
+                this.ponderId = null;
+                this.pondering = { id: response.id, moves: response.moves, bestSoFar: null };
+            }
+            return;
+        }
+
+        if (this.pondering && response.id === this.pondering.id) {
+            if (response.type === "progress") {
+                this.pondering.bestSoFar = response.move;
+            }
+            else {
+                this.pondering.result = response.move ?? this.pondering.bestSoFar;
+            }
+            return;
+        }
+
+        if (!this.pending || response.id !== this.pending.id) return; // answer to a search nobody is waiting for
+
+        if (response.type === "progress") {
+            this.pending.bestSoFar = response.move;
+        }
+        else {
+            this.finish(response.move ?? this.pending.bestSoFar);
+        }
+    }
+}
@@ -6,29 +6,6 @@ export type GameProgress = "in progress" | "not started" | "finished";
 export type PlayerColor = "black" | "white";
 export type PieceType = "pawn" | "rook" | "knight" | "bishop" | "queen" | "king";
 
-export interface Piece {
-    active: boolean;
-    
-    color: PlayerColor;
-    type: PieceType;
-
-    moves: number;
-    lastMoveIndex: number;
-}
-
-export type BoardState = Piece[][];
-
-export interface GameState {
-    moves: number;
-    previousStates: Record<string, number>;
-    lastCaptureOrPawnMove: number;
-    toMove: PlayerColor;
-    castlingAdvantageWhite: number;
-    castlingAdvantageBlack: number;
-
-    boardState: BoardState;
-}
-
 export type File = "a" | "b" | "c" | "d" | "e" | "f" | "g" | "h";
 export type Rank = "1" | "2" | "3" | "4" | "5" | "6" | "7" | "8";
 
@@ -37,13 +14,20 @@ export interface Square {
     rank: Rank;
 }
 
-export interface Move {
-    source: Square;
-    dest: Square;
-    newPieceType: PieceType;
-}
-
-export interface PossibleMove {
-    move: Move;
-    gameState: GameState;
+// what the engine's search has done, as of its last completed iteration (see search_stats.h)
+export interface SearchStats {
+    depth: number;
+    selectiveDepth: number;
+    nodes: number;
+    quiescenceNodes: number;
+    nps: number;
+    branchingFactor: number;
+    betaCutoffs: number;
+    cutoffsByMove: number[];
+    ttProbes: number;
+    ttHits: number;
+    millis: number;
+    moveGenerationMillis: number; // the three times are 0 unless the engine was built with SEARCH_PROFILE
+    evaluationMillis: number;
+    legalityMillis: number;
 }
@@ -0,0 +1,102 @@
+// @ts-ignore
+import ModuleFactory from "../engine/engine.mjs";
+
+import type { SearchWorkerRequest, SearchWorkerResponse } from "../lib/searchWorker";
+
+import { toJSSearchStats } from "../utils/jsEmbindConverter";
+import { catchUp } from "../lib/engineBoard";
+
+const enginePromise = ModuleFactory();
+
+let stopFlag: Int32Array | null = null;
+
+// the game being played, kept in the engine between requests so each search starts with what the last one learned
+let session: any = null;
+let sessionMoves: number[] = []; // the codes of the moves the session has played from the starting position
+
+// the last ponder search, which ponders on after its own move if the page says the reply it pondered on was played
+let lastPonder: { id: number; moves: number[]; move: number | null; millis: number } | null = null;
+
+function respond(response: SearchWorkerResponse) {
+    self.postMessage(response);
+}
+
+// brings the session to the position after moves, playing and taking back only the moves that differ from the last request's
+function follow(moves: number[]) {
+    sessionMoves = catchUp(sessionMoves, moves, () => session.undo(), code => session.pushMove(code));
+}
+
+// the opening book is optional: serve a book built by native/make_book as public/book.bin to enable it
+async function loadBook(engine: any) {
+    try {
+        const response = await fetch(`${import.meta.env.BASE_URL}book.bin`);
+        if (response.ok) {
+            engine.loadBook(new Uint8Array(await response.arrayBuffer()));
+        }
+    }
+    catch {
+        // no book: every move is searched
+    }
+}
+
+self.onmessage = async (event: MessageEvent<SearchWorkerRequest>) => {
+    const request = event.data;
+
+    if (request.type === "init") {
+        stopFlag = request.stopBuffer ? new Int32Array(request.stopBuffer) : null;
+
+        // builds without pthreads ignore this and search on one thread
+        const engine: any = await enginePromise;
+        session = new engine.EngineSession();
+        sessionMoves = [];
+        session.setThreads(request.threads);
+        loadBook(engine);
+        return;
+    }
+
+    const engine: any = await enginePromise;
+    session ??= new engine.EngineSession();
+
+    if (request.type === "ponderhit") {
+        if (lastPonder?.id === request.id && lastPonder.move !== null) {
+            ponder(engine, request.ponderId, [...lastPonder.moves, lastPonder.move], lastPonder.millis);
+        }
+        return;
+    }
+
+    const move = search(engine, request.id, request.moves, () => session.search(engine.MAX_DEPTH, Math.max(request.millis, 1)));
+
+    // the endgame tables take a moment to build, so build them (once) while the player thinks rather than on a search's clock
+    engine.initEndgameTables();
+
+    if (move !== null && request.ponderId !== null) {
+        ponder(engine, request.ponderId, [...request.moves, move], request.millis);
+    }
+};
+
+// catches the session up with the moves played, runs the search and reports its progress and result as move codes
+function search(engine: any, id: number, moves: number[], run: () => number) {
+    engine.stopRequested = () => stopFlag !== null && Atomics.load(stopFlag, 0) >= id;
+    engine.ponderHit = () => stopFlag !== null && Atomics.load(stopFlag, 1) === id;
+    engine.onIteration = (depth: number, score: number, move: number) => {
+        respond({ type: "progress", id, depth, score, move, stats: toJSSearchStats(engine.searchStats()) });
+    };
+
+    // usually only the last move or two are new to the session
+    follow(moves);
+    const code = run();
+    const move = code !== 0 ? code : null;
+    respond({ type: "result", id, move });
+    return move;
+}
+
+// while the player thinks, search the position after the reply the engine expects to its move (the last of moves),
+// until the page says whether it was played
+function ponder(engine: any, id: number, moves: number[], millis: number) {
+    const reply = session.expectedReply();
+    if (reply === 0) return;
+
+    const ponderMoves = [...moves, reply];
+    respond({ type: "pondering", id, moves: ponderMoves });
+    lastPonder = { id, moves: ponderMoves, move: search(engine, id, ponderMoves, () => session.ponder(Math.max(millis, 1))), millis };
+}
@@ -2,6 +2,12 @@ import { defineConfig } from 'vite'
 import react from '@vitejs/plugin-react'
 import tailwindcss from '@tailwindcss/vite'
 
+// cross-origin isolation lets the page share memory with the search worker, so a search can be stopped without killing it
+const crossOriginIsolationHeaders = {
+  "Cross-Origin-Opener-Policy": "same-origin",
+  "Cross-Origin-Embedder-Policy": "require-corp",
+}
+
 // https://vite.dev/config/
 export default defineConfig({
   plugins: [
@@ -11,5 +17,14 @@ export default defineConfig({
   base: "./",
   build: {
     outDir: "dist"
+  },
+  worker: {
+    format: "es"
+  },
+  server: {
+    headers: crossOriginIsolationHeaders
+  },
+  preview: {
+    headers: crossOriginIsolationHeaders
   }
 })